@@ -1,14 +1,26 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <assets.h>
 #include <shader_s.h>
-
+#include <async_texture_loader.h>
+#include <texture_manager.h>
+#include <gl_state.h>
+#include <uniform_buffer.h>
+#include <mesh.h>
+#include <instanced_renderer.h>
+#include <indirect_renderer.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -21,7 +33,80 @@ void processInput(GLFWwindow* window) {
   if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) glfwSetWindowShouldClose(window, true);
 }
 
-int main() {
+// Beyond the ten hand-placed cubes, fill a grid that starts just behind them and recedes
+// toward the far plane, so even 100k cubes stay (mostly) inside the frustum.
+std::vector<glm::mat4> cubeTransforms(const glm::vec3* positions, unsigned int positionCount,
+                                      unsigned int count) {
+  std::vector<glm::mat4> transforms(count);
+  unsigned int side = (unsigned int)std::ceil(std::cbrt((double)count));
+  for (unsigned int i = 0; i < count; i++) {
+    glm::vec3 position;
+    if (i < positionCount) {
+      position = positions[i];
+    } else {
+      unsigned int cell = i - positionCount;
+      position = glm::vec3(((float)(cell % side) - side * 0.5f) * 1.5f,
+                           ((float)(cell / side % side) - side * 0.5f) * 1.5f,
+                           -16.0f - (float)(cell / (side * side)) * 1.5f);
+    }
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, position);
+    float angle = 20.0f * i;
+    model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
+    transforms[i] = model;
+  }
+  return transforms;
+}
+
+// A square pyramid with the same layout as the cube, as a second mesh for --indirect
+MeshBuilder pyramidBuilder() {
+  float vertices[] = {
+      // base
+      -0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
+      0.5f, -0.5f, -0.5f, 1.0f, 0.0f,
+      0.5f, -0.5f, 0.5f, 1.0f, 1.0f,
+      0.5f, -0.5f, 0.5f, 1.0f, 1.0f,
+      -0.5f, -0.5f, 0.5f, 0.0f, 1.0f,
+      -0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
+      // sides, each up to the apex
+      -0.5f, -0.5f, 0.5f, 0.0f, 0.0f,
+      0.5f, -0.5f, 0.5f, 1.0f, 0.0f,
+      0.0f, 0.5f, 0.0f, 0.5f, 1.0f,
+      0.5f, -0.5f, 0.5f, 0.0f, 0.0f,
+      0.5f, -0.5f, -0.5f, 1.0f, 0.0f,
+      0.0f, 0.5f, 0.0f, 0.5f, 1.0f,
+      0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
+      -0.5f, -0.5f, -0.5f, 1.0f, 0.0f,
+      0.0f, 0.5f, 0.0f, 0.5f, 1.0f,
+      -0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
+      -0.5f, -0.5f, 0.5f, 1.0f, 0.0f,
+      0.0f, 0.5f, 0.0f, 0.5f, 1.0f};
+  MeshBuilder builder({3, 2});
+  builder.addTriangles(vertices, 18);
+  return builder;
+}
+
+// usage: 10cubes [cube count] [--unbatched | --indirect]
+// With a count, vsync is off and the average frame time is printed every second;
+// --unbatched issues one draw call per cube instead of one instanced draw for comparison;
+// --indirect turns every other cube into a pyramid and draws both meshes from shared buffers
+// with one multi-draw indirect call (one draw per mesh where that isn't supported).
+int main(int argc, char** argv) {
+  unsigned int cubeCount = 10;
+  bool unbatched = false;
+  bool indirect = false;
+  bool benchmark = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--unbatched") == 0) {
+      unbatched = true;
+    } else if (std::strcmp(argv[i], "--indirect") == 0) {
+      indirect = true;
+    } else {
+      cubeCount = (unsigned int)std::strtoul(argv[i], NULL, 10);
+      benchmark = true;
+    }
+  }
+
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -35,6 +120,7 @@ int main() {
   }
 
   glfwMakeContextCurrent(window);
+  if (benchmark) glfwSwapInterval(0);
   glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 
   if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
@@ -42,121 +128,123 @@ int main() {
     return -1;
   }
 
-  Shader ourShader("shader.vs", "shader.fs");
-
-  float vertices[] = {
-      -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.5f,  -0.5f, -0.5f, 1.0f, 0.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f,
-      0.5f,  0.5f,  -0.5f, 1.0f, 1.0f, -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f, -0.5f, -0.5f, -0.5f, 0.0f, 0.0f,
-
-      -0.5f, -0.5f, 0.5f,  0.0f, 0.0f, 0.5f,  -0.5f, 0.5f,  1.0f, 0.0f, 0.5f,  0.5f,  0.5f,  1.0f, 1.0f,
-      0.5f,  0.5f,  0.5f,  1.0f, 1.0f, -0.5f, 0.5f,  0.5f,  0.0f, 1.0f, -0.5f, -0.5f, 0.5f,  0.0f, 0.0f,
-
-      -0.5f, 0.5f,  0.5f,  1.0f, 0.0f, -0.5f, 0.5f,  -0.5f, 1.0f, 1.0f, -0.5f, -0.5f, -0.5f, 0.0f, 1.0f,
-      -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, -0.5f, -0.5f, 0.5f,  0.0f, 0.0f, -0.5f, 0.5f,  0.5f,  1.0f, 0.0f,
-
-      0.5f,  0.5f,  0.5f,  1.0f, 0.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f, 0.5f,  -0.5f, -0.5f, 0.0f, 1.0f,
-      0.5f,  -0.5f, -0.5f, 0.0f, 1.0f, 0.5f,  -0.5f, 0.5f,  0.0f, 0.0f, 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-
-      -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 0.5f,  -0.5f, -0.5f, 1.0f, 1.0f, 0.5f,  -0.5f, 0.5f,  1.0f, 0.0f,
-      0.5f,  -0.5f, 0.5f,  1.0f, 0.0f, -0.5f, -0.5f, 0.5f,  0.0f, 0.0f, -0.5f, -0.5f, -0.5f, 0.0f, 1.0f,
-
-      -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f, 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
-      0.5f,  0.5f,  0.5f,  1.0f, 0.0f, -0.5f, 0.5f,  0.5f,  0.0f, 0.0f, -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f};
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
+  // view and projection live in a uniform block, uploaded once per frame for all programs
+  FrameConstantsBuffer frameConstants;
 
   glm::vec3 cubePositions[] = {glm::vec3(0.0f, 0.0f, 0.0f),    glm::vec3(2.0f, 5.0f, -15.0f),
                                glm::vec3(-1.5f, -2.2f, -2.5f), glm::vec3(-3.8f, -2.0f, -12.3f),
                                glm::vec3(2.4f, -0.4f, -3.5f),  glm::vec3(-1.7f, 3.0f, -7.5f),
                                glm::vec3(1.3f, -2.0f, -2.5f),  glm::vec3(1.5f, 2.0f, -2.5f),
                                glm::vec3(1.5f, 0.2f, -1.5f),   glm::vec3(-1.3f, 1.0f, -1.5f)};
-  unsigned int VBO, VAO;
-
-  glEnable(GL_DEPTH_TEST);
-
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-
-  glEnableVertexAttribArray(1);
-
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  int width, height, nrChannels;
-  stbi_set_flip_vertically_on_load(true);
-  unsigned char* data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
+  glState().enable(GL_DEPTH_TEST);
+
+  // cube.obj, cooked by meshcook at build time: indexed, cache ordered and quantized, and
+  // uploaded straight from the embedded bytes
+  const EmbeddedAsset& cubeAsset = loadAsset("cube.mesh");
+  MeshFile cubeFile = MeshFile::fromMemory(cubeAsset.data, cubeAsset.size);
+  Mesh cube = Mesh::fromFile(cubeFile);
+  if (benchmark) {
+    std::cout << "cube: " << cube.vertexCount() << " vertices in " << cube.vertexBytes()
+              << " bytes, " << cube.indexCount() << " indices" << std::endl;
+  }
 
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
+  // per-cube model matrices go in an instance buffer at locations 2-5 of the same VAO
+  InstancedRenderer cubes(cube.VAO, 2);
+  std::vector<glm::mat4> transforms = cubeTransforms(cubePositions, 10, cubeCount);
+  cubes.setInstances(transforms.data(), transforms.size());
+
+  // the mega-buffers take meshes in meshcook's default layout: half-float positions and
+  // 16-bit texture coordinates
+  std::unique_ptr<IndirectRenderer> scene;
+  IndirectRenderer::MeshHandle sceneMeshes[2] = {-1, -1};
+  if (indirect) {
+    VertexFormat format;
+    format.add(VertexAttributeType::HalfFloat, 3).add(VertexAttributeType::Unorm16, 2);
+    scene.reset(new IndirectRenderer(format, 2));
+    sceneMeshes[0] = scene->addMesh(cubeFile);
+    sceneMeshes[1] = scene->addMesh(pyramidBuilder());
+    if (benchmark) {
+      std::cout << "indirect: " << (scene->indirect() ? "glMultiDrawElementsIndirect"
+                                                      : "one draw per mesh (no multi-draw)")
+                << std::endl;
+    }
   }
 
-  stbi_image_free(data);
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready, and the
+  // manager keeps the textures it owns within a 64 MB budget
+  AsyncTextureLoader textureLoader;
+  TextureManager textures(textureLoader, 64 << 20);
+  const EmbeddedAsset& image = loadAsset("texture.jpg");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  TextureOptions textureOptions;
+  textureOptions.minFilter = GL_LINEAR;
+  TextureManager::Handle texture =
+      textures.addCooked(cooked.data, cooked.size, image.data, image.size, textureOptions);
 
   ourShader.use();
-  ourShader.setInt("texture1", 0);
+  ourShader.set(UID("texture1"), 0);
+
+  double statsStart = glfwGetTime();
+  unsigned int statsFrames = 0;
 
   while (!glfwWindowShouldClose(window)) {
     processInput(window);
+    textureLoader.pump(2.0);
+    textures.update();
 
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glState().activeTexture(GL_TEXTURE0);
+    glState().bindTexture(GL_TEXTURE_2D, textures.use(texture));
 
-    glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 view = glm::mat4(1.0f);
     glm::mat4 projection = glm::mat4(1.0f);
 
-    model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(1.0f, 1.0f, 0.0f));
     view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
     projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
 
     ourShader.use();
-
-    unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-    unsigned int viewLoc = glGetUniformLocation(ourShader.ID, "view");
-
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
-
-    ourShader.setMat4("projection", projection);
-
-    glBindVertexArray(VAO);
-    glBindVertexArray(VAO);
-    for (unsigned int i = 0; i < 10; i++) {
-      glm::mat4 model = glm::mat4(1.0f);
-      model = glm::translate(model, cubePositions[i]);
-      float angle = 20.0f * i;
-      model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-      ourShader.setMat4("model", model);
-      glDrawArrays(GL_TRIANGLES, 0, 36);
+    frameConstants.update(view, projection);
+
+    if (scene) {
+      scene->begin();
+      for (unsigned int i = 0; i < cubeCount; i++) scene->draw(sceneMeshes[i % 2], transforms[i]);
+      scene->submit();
+    } else if (unbatched) {
+      cubes.drawElementsUnbatched(GL_TRIANGLES, (int)cube.indexCount(), cube.indexType());
+    } else {
+      cubes.drawElements(GL_TRIANGLES, (int)cube.indexCount(), cube.indexType());
     }
 
     glfwSwapBuffers(window);
     glfwPollEvents();
+
+    statsFrames++;
+    double now = glfwGetTime();
+    if (benchmark && now - statsStart >= 1.0) {
+      const GLStateCounters& stateCalls = glState().counters();
+      std::size_t drawCalls = scene ? scene->drawCalls() : (unbatched ? cubeCount : 1);
+      std::cout << cubeCount << " cubes, " << drawCalls << " draw calls: "
+                << (now - statsStart) * 1000.0 / statsFrames << " ms/frame, "
+                << stateCalls.totalElided() << " of "
+                << stateCalls.totalIssued() + stateCalls.totalElided()
+                << " state changes elided" << std::endl;
+      glState().resetCounters();
+      statsStart = now;
+      statsFrames = 0;
+    }
   }
 
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
+  cube.release();
+  frameConstants.release();
+  cubes.release();
+  if (scene) scene->release();
+
+  textures.release();
+  textureLoader.deleteStagingBuffers();
 
   glfwTerminate();
   return 0;
@@ -1,13 +1,18 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <async_texture_loader.h>
+#include <gl_state.h>
+#include <uniform_buffer.h>
+#include <mesh.h>
 
+#include <cstdint>
 #include <iostream>
 
 const unsigned int SCR_WIDTH = 800;
@@ -42,7 +47,10 @@ int main() {
     return -1;
   }
 
-  Shader ourShader("shader.vs", "shader.fs");
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
+  // view and projection live in a uniform block, uploaded once per frame for all programs
+  FrameConstantsBuffer frameConstants;
 
   float vertices[] = {
       // positions          // texture coords
@@ -57,61 +65,40 @@ int main() {
       1, 2, 3   // second triangle
   };
 
-  unsigned int VBO, VAO, EBO;
-
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glGenBuffers(1, &EBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-
-  glEnableVertexAttribArray(1);
-
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  int width, height, nrChannels;
-  stbi_set_flip_vertically_on_load(true);
-  unsigned char* data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
-
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
+  // already indexed, so the builder only shares the GL setup (and picks 16-bit indices);
+  // the triangles go through the ids addVertex() hands back, which differ once corners weld
+  MeshBuilder builder({3, 2});
+  std::uint32_t corners[4];
+  for (int i = 0; i < 4; i++) corners[i] = builder.addVertex(vertices + i * 5);
+  for (int i = 0; i < 6; i += 3) {
+    builder.addTriangle(corners[indices[i]], corners[indices[i + 1]], corners[indices[i + 2]]);
   }
-
-  stbi_image_free(data);
+  // half-float positions and 16-bit texture coordinates: 12 bytes a vertex instead of 20
+  VertexFormat format;
+  format.add(VertexAttributeType::HalfFloat, 3).add(VertexAttributeType::Unorm16, 2);
+  Mesh quad = builder.build(format);
+
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready
+  AsyncTextureLoader textureLoader;
+  const EmbeddedAsset& image = loadAsset("texture.jpg");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  TextureOptions textureOptions;
+  textureOptions.minFilter = GL_LINEAR;
+  unsigned int texture =
+      textureLoader.loadCooked(cooked.data, cooked.size, image.data, image.size, textureOptions);
 
   ourShader.use();
-  ourShader.setInt("texture1", 0);
+  ourShader.set(UID("texture1"), 0);
 
   while (!glfwWindowShouldClose(window)) {
     processInput(window);
+    textureLoader.pump(2.0);
 
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glState().activeTexture(GL_TEXTURE0);
+    glState().bindTexture(GL_TEXTURE_2D, texture);
 
     glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 view = glm::mat4(1.0f);
@@ -123,24 +110,19 @@ int main() {
 
     ourShader.use();
 
-    unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-    unsigned int viewLoc = glGetUniformLocation(ourShader.ID, "view");
-
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
+    ourShader.set(UID("model"), model);
+    frameConstants.update(view, projection);
 
-    ourShader.setMat4("projection", projection);
-
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    quad.draw();
 
     glfwSwapBuffers(window);
     glfwPollEvents();
   }
 
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
-  glDeleteBuffers(1, &EBO);
+  quad.release();
+  frameConstants.release();
+
+  textureLoader.deleteStagingBuffers();
 
   glfwTerminate();
   return 0;
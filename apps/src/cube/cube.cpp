@@ -1,12 +1,16 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <async_texture_loader.h>
+#include <gl_state.h>
+#include <uniform_buffer.h>
+#include <mesh.h>
 
 #include <iostream>
 
@@ -42,7 +46,10 @@ int main() {
     return -1;
   }
 
-  Shader ourShader("shader.vs", "shader.fs");
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
+  // view and projection live in a uniform block, uploaded once per frame for all programs
+  FrameConstantsBuffer frameConstants;
 
   float vertices[] = {
       -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.5f,  -0.5f, -0.5f, 1.0f, 0.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f,
@@ -63,59 +70,38 @@ int main() {
       -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f, 0.5f,  0.5f,  -0.5f, 1.0f, 1.0f, 0.5f,  0.5f,  0.5f,  1.0f, 0.0f,
       0.5f,  0.5f,  0.5f,  1.0f, 0.0f, -0.5f, 0.5f,  0.5f,  0.0f, 0.0f, -0.5f, 0.5f,  -0.5f, 0.0f, 1.0f};
 
-  unsigned int VBO, VAO;
-
-  glEnable(GL_DEPTH_TEST);
-
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-
-  glEnableVertexAttribArray(1);
-
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-  int width, height, nrChannels;
-  stbi_set_flip_vertically_on_load(true);
-  unsigned char* data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
-
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
-  }
-
-  stbi_image_free(data);
+  glState().enable(GL_DEPTH_TEST);
+
+  // the 36 corners above are only 16 distinct vertices; the builder welds them into an
+  // indexed mesh
+  MeshBuilder builder({3, 2});
+  builder.addTriangles(vertices, 36);
+  // half-float positions and 16-bit texture coordinates: 12 bytes a vertex instead of 20
+  VertexFormat format;
+  format.add(VertexAttributeType::HalfFloat, 3).add(VertexAttributeType::Unorm16, 2);
+  Mesh cube = builder.build(format);
+
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready
+  AsyncTextureLoader textureLoader;
+  const EmbeddedAsset& image = loadAsset("texture.jpg");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  TextureOptions textureOptions;
+  textureOptions.minFilter = GL_LINEAR;
+  unsigned int texture =
+      textureLoader.loadCooked(cooked.data, cooked.size, image.data, image.size, textureOptions);
 
   ourShader.use();
-  ourShader.setInt("texture1", 0);
+  ourShader.set(UID("texture1"), 0);
 
   while (!glfwWindowShouldClose(window)) {
     processInput(window);
+    textureLoader.pump(2.0);
 
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glState().activeTexture(GL_TEXTURE0);
+    glState().bindTexture(GL_TEXTURE_2D, texture);
 
     glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 view = glm::mat4(1.0f);
@@ -127,23 +113,19 @@ int main() {
 
     ourShader.use();
 
-    unsigned int modelLoc = glGetUniformLocation(ourShader.ID, "model");
-    unsigned int viewLoc = glGetUniformLocation(ourShader.ID, "view");
-
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, &view[0][0]);
+    ourShader.set(UID("model"), model);
+    frameConstants.update(view, projection);
 
-    ourShader.setMat4("projection", projection);
-
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    cube.draw();
 
     glfwSwapBuffers(window);
     glfwPollEvents();
   }
 
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
+  cube.release();
+  frameConstants.release();
+
+  textureLoader.deleteStagingBuffers();
 
   glfwTerminate();
   return 0;
@@ -1,12 +1,15 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <async_texture_loader.h>
+#include <gl_state.h>
+#include <uniform_buffer.h>
 
 #include <iostream>
 
@@ -47,9 +50,12 @@ int main() {
   }
 
   // Enable depth testing for 3D
-  glEnable(GL_DEPTH_TEST);
+  glState().enable(GL_DEPTH_TEST);
 
-  Shader ourShader("shader.vs", "shader.fs");
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
+  // view and projection live in a uniform block, uploaded once per frame for all programs
+  FrameConstantsBuffer frameConstants;
   float vertices[] = {
       // positions       // texture coords
       0.1f,  0.1f,  0.0f, 1.0f, 1.0f,  // top right
@@ -80,30 +86,12 @@ int main() {
   glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
   glEnableVertexAttribArray(1);
 
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                  GL_REPEAT);  // set texture wrapping to GL_REPEAT (default wrapping method)
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                  GL_LINEAR);  // load image, create texture and generate mipmaps
-  int width, height, nrChannels;
-
-  stbi_set_flip_vertically_on_load(true);
-
-  unsigned char* data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
-  }
-  stbi_image_free(data);
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready
+  AsyncTextureLoader textureLoader;
+  const EmbeddedAsset& image = loadAsset("texture.jpg");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  unsigned int texture =
+      textureLoader.loadCooked(cooked.data, cooked.size, image.data, image.size);
 
   while (!glfwWindowShouldClose(window)) {
     // Calculate delta time
@@ -112,11 +100,14 @@ int main() {
     lastFrame = currentFrame;
 
     processInput(window);
+    textureLoader.pump(2.0);
 
     glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glState().activeTexture(GL_TEXTURE0);
+
+    glState().bindTexture(GL_TEXTURE_2D, texture);
     ourShader.use();
 
     glm::mat4 model = glm::mat4(1.0f);
@@ -133,10 +124,9 @@ int main() {
     glm::mat4 projection =
         glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
 
-    ourShader.setMat4("model", model);
-    ourShader.setMat4("view", view);
-    ourShader.setMat4("projection", projection);
-    glBindVertexArray(VAO);
+    ourShader.set(UID("model"), model);
+    frameConstants.update(view, projection);
+    glState().bindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
     glfwSwapBuffers(window);
@@ -145,8 +135,11 @@ int main() {
 
   glDeleteVertexArrays(1, &VAO);
   glDeleteBuffers(1, &VBO);
+  frameConstants.release();
   glDeleteBuffers(1, &EBO);
 
+  textureLoader.deleteStagingBuffers();
+
   glfwTerminate();
   return 0;
 }
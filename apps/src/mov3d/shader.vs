@@ -3,8 +3,11 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform FrameConstants
+{
+	mat4 view;
+	mat4 projection;
+};
 
 out vec2 TexCoord;
 
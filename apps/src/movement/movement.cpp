@@ -1,8 +1,11 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <async_texture_loader.h>
+#include <gl_state.h>
+#include <sprite_batch.h>
 
 #include <iostream>
 
@@ -46,85 +49,24 @@ int main() {
     return -1;
   }
 
-  Shader ourShader("shader.vs", "shader.fs");
-  float vertices[] = {
-      // positions       // texture coords
-      0.1f,  0.1f,  0.0f, 1.0f, 1.0f,  // top right
-      0.1f,  -0.1f, 0.0f, 1.0f, 0.0f,  // bottom right
-      -0.1f, -0.1f, 0.0f, 0.0f, 0.0f,  // bottom left
-      -0.1f, 0.1f,  0.0f, 0.0f, 1.0f   // top left
-  };
-
-  // Calculate texture boundaries dynamically from vertex data
-  float minX = vertices[0], maxX = vertices[0];  // Start with first X coordinate
-  float minY = vertices[1], maxY = vertices[1];  // Start with first Y coordinate
-
-  // Find min/max X and Y from all vertices
-  for (int i = 0; i < 4; i++) {
-    float x = vertices[i * 5];      // X coordinate (every 5th element starting from 0)
-    float y = vertices[i * 5 + 1];  // Y coordinate (every 5th element starting from 1)
-
-    if (x < minX) minX = x;
-    if (x > maxX) maxX = x;
-    if (y < minY) minY = y;
-    if (y > maxY) maxY = y;
-  }
-
-  // Calculate half-widths from the min/max values
-  textureHalfWidth = (maxX - minX) / 2.0f;
-  textureHalfHeight = (maxY - minY) / 2.0f;
-
-  unsigned int indices[] = {
-      0, 1, 3,  // first triangle
-      1, 2, 3   // second triangle
-  };
-  unsigned int VBO, VAO, EBO;
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glGenBuffers(1, &EBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
 
-  // texture coord attribute
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-  glEnableVertexAttribArray(1);
+  // the quad's size in normalized device coordinates
+  const glm::vec2 spriteSize(0.2f, 0.2f);
+  textureHalfWidth = spriteSize.x / 2.0f;
+  textureHalfHeight = spriteSize.y / 2.0f;
 
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
+  // rebuilds the quad at its new position every frame, in one streaming buffer
+  SpriteBatch sprites;
 
-  // set the texture wrapping parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                  GL_REPEAT);  // set texture wrapping to GL_REPEAT (default wrapping method)
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready
+  AsyncTextureLoader textureLoader;
+  const EmbeddedAsset& image = loadAsset("texture.jpg");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  unsigned int texture =
+      textureLoader.loadCooked(cooked.data, cooked.size, image.data, image.size);
 
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  // set texture filtering parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                  GL_LINEAR);  // load image, create texture and generate mipmaps
-  int width, height, nrChannels;
-
-  // Don't flip the image when loading - we'll handle flipping with texture coordinates
-  stbi_set_flip_vertically_on_load(true);
-
-  unsigned char* data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
-  }
-  stbi_image_free(data);
   while (!glfwWindowShouldClose(window)) {
     // Calculate deltaTime for frame-rate independent movement
     float currentFrame = glfwGetTime();
@@ -132,28 +74,25 @@ int main() {
     lastFrame = currentFrame;
 
     processInput(window);
+    textureLoader.pump(2.0);
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // bind Texture
-    glBindTexture(GL_TEXTURE_2D, texture);  // render container
+    // render container
+    glState().activeTexture(GL_TEXTURE0);
     ourShader.use();
-
-    // Set the offset uniform (vec2)
-    int offsetLocation = glGetUniformLocation(ourShader.ID, "offset");
-    glUniform2f(offsetLocation, offsetX, offsetY);
-
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    sprites.begin();
+    sprites.draw(GL_TEXTURE_2D, texture, glm::vec2(offsetX, offsetY), spriteSize);
+    sprites.end();
 
     glfwSwapBuffers(window);
     glfwPollEvents();
   }
 
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
-  glDeleteBuffers(1, &EBO);
+  sprites.release();
+
+  textureLoader.deleteStagingBuffers();
 
   glfwTerminate();
   return 0;
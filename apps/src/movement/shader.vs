@@ -1,13 +1,14 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
-
-uniform vec2 offset;
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec3 aTexCoord;
+layout (location = 2) in vec4 aColor;
 
 out vec2 TexCoord;
+out vec4 Color;
 
 void main()
 {
-	gl_Position = vec4(aPos.x + offset.x, aPos.y + offset.y, aPos.z, 1.0);
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	gl_Position = vec4(aPos, 0.0, 1.0);
+	TexCoord = aTexCoord.xy;
+	Color = aColor;
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <sprite_batch.h>
+
 #include <iostream>
 
 const unsigned int SCR_WIDTH = 800;
@@ -40,55 +43,18 @@ int main() {
     return -1;
   }
 
-  Shader ourShader("shader.vs", "shader.fs");
-
-  float vertices[] = {
-      // positions
-      0.15f,  -0.9f, 0.0f,  // top right
-      0.15f,  -1.0f, 0.0f,  // bottom right
-      -0.15f, -1.0f, 0.0f,  // bottom left
-      -0.15f, -0.9f, 0.0f   // top left
-  };
-
-  unsigned int indices[] = {
-      0, 1, 3,  // first triangle
-      1, 2, 3   // second triangle
-  };
-
-  float minX = vertices[0], maxX = vertices[0];  // Start with first X coordinate
-  float minY = vertices[1], maxY = vertices[1];  // Start with first Y coordinate
-
-  for (int i = 0; i < 4; i++) {
-    float x = vertices[i * 3];      // X coordinate (every 5th element starting from 0)
-    float y = vertices[i * 3 + 1];  // Y coordinate (every 5th element starting from 1)
-
-    if (x < minX) minX = x;
-    if (x > maxX) maxX = x;
-    if (y < minY) minY = y;
-    if (y > maxY) maxY = y;
-  }
-
-  textureHalfWidth = (maxX - minX) / 2.0f;
-  textureHalfHeight = (maxY - minY) / 2.0f;
-
-  unsigned int VBO, VAO, EBO;
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glGenBuffers(1, &EBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
 
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+  // the paddle: an untextured yellow quad along the bottom edge, moved by its centre
+  const glm::vec2 paddleSize(0.3f, 0.1f);
+  const glm::vec2 paddleStart(0.0f, -0.95f);
+  const glm::vec4 paddleColor(1.0f, 1.0f, 0.0f, 1.0f);
+  textureHalfWidth = paddleSize.x / 2.0f;
+  textureHalfHeight = paddleSize.y / 2.0f;
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  // the same streaming batch the textured sprite apps use; texture 0 is its untextured bucket
+  SpriteBatch sprites;
 
   while (!glfwWindowShouldClose(window)) {
     float currentFrame = glfwGetTime();
@@ -101,21 +67,16 @@ int main() {
     glClear(GL_COLOR_BUFFER_BIT);
 
     ourShader.use();
-
-    int offsetLocation = glGetUniformLocation(ourShader.ID, "offset");
-    glUniform2f(offsetLocation, offsetX, offsetY);
-
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    sprites.begin();
+    sprites.draw(GL_TEXTURE_2D, 0, paddleStart + glm::vec2(offsetX, offsetY), paddleSize, {},
+                 paddleColor);
+    sprites.end();
 
     glfwSwapBuffers(window);
     glfwPollEvents();
   }
 
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
-  glDeleteBuffers(1, &EBO);
+  sprites.release();
 
   return 0;
 }
@@ -1,10 +1,10 @@
 #version 330 core
-layout(location=0) in vec3 aPos;
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec3 aTexCoord;
+layout (location = 2) in vec4 aColor;
 out vec4 rColor;
 
-uniform vec2 offset;
-
 void main(){
-    gl_Position = vec4(aPos.x + offset.x, aPos.y + offset.y, aPos.z, 1.0);
-    rColor = vec4(1.0f, 1.0f, 0.0f, 1.0f);
+    gl_Position = vec4(aPos, 0.0, 1.0);
+    rColor = aColor;
 }
\ No newline at end of file
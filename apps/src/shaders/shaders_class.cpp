@@ -1,7 +1,9 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <gl_state.h>
 
 #include <iostream>
 
@@ -40,8 +42,9 @@ int main() {
 
   // build and compile our shader program
   // ------------------------------------
-  Shader ourShader("shaders.vs",
-                   "shaders.fs");  // you can name your shader files however you like
+  // you can name your shader files however you like
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shaders.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shaders.fs").text()));
   // set up vertex data (and buffer(s)) and configure vertex attributes
   // ------------------------------------------------------------------
   float vertices[] = {
@@ -80,7 +83,7 @@ int main() {
 
     // render the triangle
     ourShader.use();
-    glBindVertexArray(VAO);
+    glState().bindVertexArray(VAO);
     glDrawArrays(GL_TRIANGLES, 0, 3);
 
     // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -2,13 +2,14 @@
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in vec4 Color;
 
 // texture sampler
 uniform sampler2D texture1;
 
 void main()
 {
-    vec4 texColor = texture(texture1, TexCoord);
+    vec4 texColor = texture(texture1, TexCoord) * Color;
     
     // Discard pixels with very low alpha (optional, for sharper edges)
     if(texColor.a < 0.1)
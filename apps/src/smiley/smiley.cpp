@@ -1,10 +1,17 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <async_texture_loader.h>
+#include <gl_state.h>
+#include <sprite_batch.h>
 
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow* window);
@@ -26,7 +33,36 @@ float textureHalfHeight = 0.0f;  // will be calculated from vertices
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main() {
+// a benchmark sprite bouncing around the window
+struct MovingSprite {
+  glm::vec2 position;
+  glm::vec2 velocity;
+  glm::vec4 color;
+};
+
+float randomRange(float low, float high) {
+  return low + (high - low) * ((float)std::rand() / (float)RAND_MAX);
+}
+
+// usage: smiley [sprite count] [--hot-reload]
+// With a count, that many small smileys bounce around behind the one you steer, vsync is
+// off and the average frame time is printed every second. They all share one texture, so
+// the SpriteBatch draws them with one draw call per 16384 sprites.
+// --hot-reload watches apps/src/smiley/shader.vs/.fs in the source tree and rebuilds the
+// program when they change; without it the app only uses the embedded shaders.
+int main(int argc, char** argv) {
+  unsigned int spriteCount = 0;
+  bool benchmark = false;
+  bool hotReload = false;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--hot-reload") == 0) {
+      hotReload = true;
+    } else {
+      spriteCount = (unsigned int)std::strtoul(argv[i], NULL, 10);
+      benchmark = true;
+    }
+  }
+
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -39,6 +75,7 @@ int main() {
     return -1;
   }
   glfwMakeContextCurrent(window);
+  if (benchmark) glfwSwapInterval(0);
   glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
   if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
     std::cout << "Failed to initialize GLAD" << std::endl;
@@ -46,102 +83,46 @@ int main() {
   }
 
   // Enable alpha blending for transparency
-  glEnable(GL_BLEND);
+  glState().enable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  Shader ourShader("shader.vs", "shader.fs");
-  float vertices[] = {
-      // positions       // texture coords
-      0.1f,  0.1f,  0.0f, 1.0f, 1.0f,  // top right
-      0.1f,  -0.1f, 0.0f, 1.0f, 0.0f,  // bottom right
-      -0.1f, -0.1f, 0.0f, 0.0f, 0.0f,  // bottom left
-      -0.1f, 0.1f,  0.0f, 0.0f, 1.0f   // top left
-  };
-
-  // Calculate texture boundaries dynamically from vertex data
-  float minX = vertices[0], maxX = vertices[0];  // Start with first X coordinate
-  float minY = vertices[1], maxY = vertices[1];  // Start with first Y coordinate
-
-  // Find min/max X and Y from all vertices
-  for (int i = 0; i < 4; i++) {
-    float x = vertices[i * 5];      // X coordinate (every 5th element starting from 0)
-    float y = vertices[i * 5 + 1];  // Y coordinate (every 5th element starting from 1)
-
-    if (x < minX) minX = x;
-    if (x > maxX) maxX = x;
-    if (y < minY) minY = y;
-    if (y > maxY) maxY = y;
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
+  if (hotReload) {
+    ourShader.enableHotReload(APP_SOURCE_DIR "/shader.vs", APP_SOURCE_DIR "/shader.fs");
   }
 
-  // Calculate half-widths from the min/max values
-  textureHalfWidth = (maxX - minX) / 2.0f;
-  textureHalfHeight = (maxY - minY) / 2.0f;
-
-  unsigned int indices[] = {
-      0, 1, 3,  // first triangle
-      1, 2, 3   // second triangle
-  };
-  unsigned int VBO, VAO, EBO;
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-  glGenBuffers(1, &EBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  // texture coord attribute
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-  glEnableVertexAttribArray(1);
-
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(GL_TEXTURE_2D, texture);
-
-  // set the texture wrapping parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                  GL_REPEAT);  // set texture wrapping to GL_REPEAT (default wrapping method)
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  // set texture filtering parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                  GL_LINEAR);  // load image, create texture and generate mipmaps
-  int width, height, nrChannels;
-  // Don't flip the image when loading - we'll handle flipping with texture coordinates
-  stbi_set_flip_vertically_on_load(true);
-
-  unsigned char* data = stbi_load("texture.png", &width, &height, &nrChannels, 0);
-  if (data) {
-    // Handle both RGB and RGBA formats
-    GLenum format = GL_RGB;
-    if (nrChannels == 4) {
-      format = GL_RGBA;
-    } else if (nrChannels == 3) {
-      format = GL_RGB;
-    } else if (nrChannels == 1) {
-      format = GL_RED;
-    }
+  // the smiley's size in normalized device coordinates
+  const glm::vec2 spriteSize(0.2f, 0.2f);
+  textureHalfWidth = spriteSize.x / 2.0f;
+  textureHalfHeight = spriteSize.y / 2.0f;
+
+  // every quad of the frame goes through one streaming buffer
+  SpriteBatch sprites;
+  std::vector<MovingSprite> crowd(spriteCount);
+  for (MovingSprite& sprite : crowd) {
+    sprite.position = glm::vec2(randomRange(-0.95f, 0.95f), randomRange(-0.95f, 0.95f));
+    sprite.velocity = glm::vec2(randomRange(-0.5f, 0.5f), randomRange(-0.5f, 0.5f));
+    sprite.color = glm::vec4(randomRange(0.3f, 1.0f), randomRange(0.3f, 1.0f),
+                             randomRange(0.3f, 1.0f), 1.0f);
+  }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready
+  AsyncTextureLoader textureLoader;
+  const EmbeddedAsset& image = loadAsset("texture.png");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  unsigned int texture =
+      textureLoader.loadCooked(cooked.data, cooked.size, image.data, image.size);
+
+  ourShader.use();
+  ourShader.set(UID("texture1"), 0);
+
+  double statsStart = glfwGetTime();
+  unsigned int statsFrames = 0;
 
-    std::cout << "Texture loaded successfully: " << width << "x" << height << " with " << nrChannels
-              << " channels" << std::endl;
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
-  }
-  stbi_image_free(data);
   while (!glfwWindowShouldClose(window)) {
     processInput(window);
+    textureLoader.pump(2.0);
     // Calculate deltaTime for frame-rate independent movement
     float currentFrame = glfwGetTime();
     deltaTime = currentFrame - lastFrame;
@@ -151,24 +132,42 @@ int main() {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // bind Texture
-    glBindTexture(GL_TEXTURE_2D, texture);  // render container
+    glState().activeTexture(GL_TEXTURE0);
+    ourShader.pollHotReload();
     ourShader.use();
 
-    // Set the offset uniform (vec2)
-    int offsetLocation = glGetUniformLocation(ourShader.ID, "offset");
-    glUniform2f(offsetLocation, offsetX, offsetY);
-
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    sprites.begin();
+    for (MovingSprite& sprite : crowd) {
+      sprite.position += sprite.velocity * deltaTime;
+      if (sprite.position.x * sprite.velocity.x > 0.0f && std::abs(sprite.position.x) > 1.0f) {
+        sprite.velocity.x = -sprite.velocity.x;
+      }
+      if (sprite.position.y * sprite.velocity.y > 0.0f && std::abs(sprite.position.y) > 1.0f) {
+        sprite.velocity.y = -sprite.velocity.y;
+      }
+      sprites.draw(GL_TEXTURE_2D, texture, sprite.position, spriteSize * 0.25f, TextureRegion(),
+                   sprite.color);
+    }
+    sprites.draw(GL_TEXTURE_2D, texture, glm::vec2(offsetX, offsetY), spriteSize);
+    sprites.end();
 
     glfwSwapBuffers(window);
     glfwPollEvents();
+
+    statsFrames++;
+    double now = glfwGetTime();
+    if (benchmark && now - statsStart >= 1.0) {
+      std::cout << sprites.quadCount() << " sprites, " << sprites.drawCalls() << " draw calls: "
+                << (now - statsStart) * 1000.0 / statsFrames << " ms/frame, "
+                << sprites.stream().stalls() << " stream stalls" << std::endl;
+      statsStart = now;
+      statsFrames = 0;
+    }
   }
 
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
-  glDeleteBuffers(1, &EBO);
+  sprites.release();
+
+  textureLoader.deleteStagingBuffers();
 
   glfwTerminate();
   return 0;
@@ -1,8 +1,10 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
-#include <stb_image.h>
 
+#include <assets.h>
 #include <shader_s.h>
+#include <async_texture_loader.h>
+#include <gl_state.h>
 
 #include <iostream>
 
@@ -33,7 +35,8 @@ int main() {
     return -1;
   }
 
-  Shader ourShader("shader.vs", "shader.fs");
+  Shader ourShader(ShaderSource::fromMemory(loadAsset("shader.vs").text()),
+                   ShaderSource::fromMemory(loadAsset("shader.fs").text()));
 
   float vertices[] = {
       // positions   // texture coords
@@ -66,35 +69,12 @@ int main() {
   glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
   glEnableVertexAttribArray(1);
 
-  unsigned int texture;
-  glGenTextures(1, &texture);
-  glBindTexture(
-      GL_TEXTURE_2D,
-      texture);  // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
-
-  // set the texture wrapping parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,
-                  GL_REPEAT);  // set texture wrapping to GL_REPEAT (default wrapping method)
-
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-  // set texture filtering parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
-                  GL_LINEAR);  // load image, create texture and generate mipmaps
-  int width, height, nrChannels;
-
-  // Don't flip the image when loading - we'll handle flipping with texture coordinates
-  stbi_set_flip_vertically_on_load(true);
-
-  unsigned char* data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
-  if (data) {
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
-  } else {
-    std::cout << "Failed to load texture" << std::endl;
-  }
-  stbi_image_free(data);
+  // decoded on a worker thread; pump() in the render loop uploads it once it's ready
+  AsyncTextureLoader textureLoader;
+  const EmbeddedAsset& image = loadAsset("texture.jpg");
+  const EmbeddedAsset& cooked = loadAsset("texture.ctex");
+  unsigned int texture =
+      textureLoader.loadCooked(cooked.data, cooked.size, image.data, image.size);
 
   // render loop
   // -----------
@@ -102,6 +82,7 @@ int main() {
     // input
     // -----
     processInput(window);
+    textureLoader.pump(2.0);
 
     // render
     // ------
@@ -109,11 +90,12 @@ int main() {
     glClear(GL_COLOR_BUFFER_BIT);
 
     // bind Texture
-    glBindTexture(GL_TEXTURE_2D, texture);
+    glState().activeTexture(GL_TEXTURE0);
+    glState().bindTexture(GL_TEXTURE_2D, texture);
 
     // render container
     ourShader.use();
-    glBindVertexArray(VAO);
+    glState().bindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
     glfwSwapBuffers(window);
@@ -124,6 +106,8 @@ int main() {
   glDeleteBuffers(1, &VBO);
   glDeleteBuffers(1, &EBO);
 
+  textureLoader.deleteStagingBuffers();
+
   glfwTerminate();
   return 0;
 }
@@ -0,0 +1,36 @@
+# Script mode helper for embed_assets(): writes a C++ source holding every input file as a
+# constexpr byte array, plus a table that registers them with the assets library.
+#
+#   cmake -DOUTPUT=<file.cpp> -DFILE_LIST=<a|b|c> -P embed_assets.cmake
+
+string(REPLACE "|" ";" FILES "${FILE_LIST}")
+
+set(LINE_PATTERN "")
+foreach(I RANGE 1 16)
+    string(APPEND LINE_PATTERN "[0-9a-f][0-9a-f]")
+endforeach()
+
+set(ARRAYS "")
+set(ENTRIES "")
+set(INDEX 0)
+foreach(FILE_PATH ${FILES})
+    get_filename_component(FILE_NAME ${FILE_PATH} NAME)
+    file(READ ${FILE_PATH} HEX HEX)
+    # 16 bytes per line, then turn every byte into "0x??,"
+    string(REGEX REPLACE "(${LINE_PATTERN})" "\\1\n    " HEX "${HEX}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," HEX "${HEX}")
+    # trailing '\0' so text assets can be used as C strings; it isn't counted in the size
+    string(APPEND ARRAYS "alignas(16) constexpr unsigned char asset${INDEX}[] = {\n    ${HEX}0x00};\n")
+    string(APPEND ENTRIES "    {\"${FILE_NAME}\", asset${INDEX}, sizeof(asset${INDEX}) - 1},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+set(CONTENT "// Generated by embed_assets.cmake, do not edit.\n\n#include <assets.h>\n\nnamespace {\n\n")
+string(APPEND CONTENT "${ARRAYS}\nconst EmbeddedAsset assets[] = {\n${ENTRIES}};\n\n")
+string(APPEND CONTENT "const bool registered = (registerAssets(assets, sizeof(assets) / sizeof(assets[0])), true);\n\n")
+string(APPEND CONTENT "}  // namespace\n")
+
+# only touch the file when something changed, so dependents don't rebuild needlessly
+file(WRITE ${OUTPUT}.tmp "${CONTENT}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different ${OUTPUT}.tmp ${OUTPUT})
+file(REMOVE ${OUTPUT}.tmp)
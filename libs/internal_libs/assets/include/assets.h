@@ -0,0 +1,25 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <cstddef>
+
+// A file compiled into the executable by the embed_assets() CMake function. The bytes are
+// followed by a '\0' that isn't counted in size, so text assets double as C strings.
+struct EmbeddedAsset {
+  const char *name;
+  const unsigned char *data;
+  std::size_t size;
+
+  const char *text() const { return (const char *)data; }
+};
+
+// called by the generated asset tables during static initialisation
+void registerAssets(const EmbeddedAsset *assets, std::size_t count);
+
+// look an asset up by file name, e.g. findAsset("shader.vs"); null if it wasn't embedded
+const EmbeddedAsset *findAsset(const char *name);
+
+// same, but reports a missing asset and hands back an empty one instead of null
+const EmbeddedAsset &loadAsset(const char *name);
+
+#endif
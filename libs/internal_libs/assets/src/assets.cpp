@@ -0,0 +1,36 @@
+#include "assets.h"
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// function-local so it exists before any generated table registers itself
+std::vector<const EmbeddedAsset*>& registry() {
+  static std::vector<const EmbeddedAsset*> assets;
+  return assets;
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+void registerAssets(const EmbeddedAsset* assets, std::size_t count) {
+  for (std::size_t i = 0; i < count; i++) registry().push_back(&assets[i]);
+}
+// ------------------------------------------------------------------------
+const EmbeddedAsset* findAsset(const char* name) {
+  for (const EmbeddedAsset* asset : registry()) {
+    if (std::strcmp(asset->name, name) == 0) return asset;
+  }
+  return nullptr;
+}
+// ------------------------------------------------------------------------
+const EmbeddedAsset& loadAsset(const char* name) {
+  static const unsigned char nothing[1] = {0};
+  static const EmbeddedAsset empty = {"", nothing, 0};
+  const EmbeddedAsset* asset = findAsset(name);
+  if (asset) return *asset;
+  std::cout << "ERROR::ASSETS::NOT_EMBEDDED: " << name << std::endl;
+  return empty;
+}
@@ -0,0 +1,70 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <mapped_file.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// one vertex attribute exactly as glVertexAttribPointer takes it
+struct MeshFileAttribute {
+  std::uint32_t location;
+  std::uint32_t components;  // the size argument
+  std::uint32_t glType;      // GL_FLOAT, GL_HALF_FLOAT, GL_INT_2_10_10_10_REV, ...
+  std::uint32_t normalized;
+  std::uint32_t offset;      // within a vertex
+};
+
+// A cooked mesh, written by meshcook. Like TextureCacheFile the file is a fixed header, a
+// table (here of attributes) and then the data exactly as GL takes it: the interleaved
+// vertices for GL_ARRAY_BUFFER and the indices for GL_ELEMENT_ARRAY_BUFFER, each section
+// aligned. Loading maps the file, checks the header and hands the two sections to
+// glBufferData; there's nothing to parse.
+//
+//   MeshFileHeader | MeshFileAttribute[attributeCount] | padding | vertices | padding | indices
+class MeshFile {
+ public:
+  MeshFile();
+  // maps a mesh file; valid() is false if it can't be read or doesn't check out
+  static MeshFile open(const std::string &path);
+  // reads a mesh that is already in memory, which must outlive the result
+  static MeshFile fromMemory(const void *data, std::size_t size);
+
+  bool valid() const;
+  const std::vector<MeshFileAttribute> &attributes() const;
+  std::uint32_t vertexStride() const;
+  std::uint32_t vertexCount() const;
+  const unsigned char *vertexData() const;
+  std::size_t vertexDataSize() const;
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  std::uint32_t indexType() const;
+  std::uint32_t indexCount() const;
+  const unsigned char *indexData() const;
+  std::size_t indexDataSize() const;
+  // model-space bounding box of the positions
+  const float *boundsMin() const;
+  const float *boundsMax() const;
+
+  // the file appears atomically, so a reader never sees half of it
+  static bool write(const std::string &path, const std::vector<MeshFileAttribute> &attributes,
+                    std::uint32_t vertexStride, std::uint32_t vertexCount,
+                    const void *vertexData, std::uint32_t indexType, std::uint32_t indexCount,
+                    const void *indexData, const float boundsMin[3], const float boundsMax[3]);
+
+ private:
+  MappedFile file;
+  std::vector<MeshFileAttribute> attributeList;
+  std::uint32_t stride;
+  std::uint32_t vertices;
+  std::uint32_t type;
+  std::uint32_t indices;
+  const unsigned char *vertexBytes;
+  const unsigned char *indexBytes;
+  float minimum[3];
+  float maximum[3];
+
+  void parse(const unsigned char *bytes, std::size_t size);
+};
+#endif
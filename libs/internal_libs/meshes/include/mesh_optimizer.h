@@ -0,0 +1,49 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Reordering passes for indexed triangle lists, run offline by meshopt or at load time. None of
+// them changes what is drawn, only the order the GPU meets it in:
+//   optimizeVertexCache  triangles in the order that best reuses the post-transform vertex
+//                        cache (Forsyth's linear-speed greedy scoring)
+//   optimizeOverdraw     clusters of that order sorted outside-in, so near, outward facing
+//                        surfaces fill the depth buffer first (Tipsify's second pass); costs a
+//                        little of the cache gain, bounded by `threshold`
+//   optimizeVertexFetch  vertices in the order the indices first use them, so fetches walk
+//                        the vertex buffer forwards; drops unreferenced vertices
+// Run them in that order: the overdraw pass only regroups what the cache pass produced, and
+// the fetch pass renumbers vertices, which the other two don't care about.
+
+// how well an index order uses a FIFO post-transform cache of `cacheSize` vertices
+struct VertexCacheStats {
+  std::size_t transformedVertices;  // cache misses: vertex shader runs
+  float acmr;  // average cache miss ratio: transforms per triangle, 0.5 at best, 3 at worst
+  float atvr;  // average transform to vertex ratio: transforms per referenced vertex, 1 at best
+};
+
+VertexCacheStats analyzeVertexCache(const std::uint32_t *indices, std::size_t indexCount,
+                                    std::size_t vertexCount, unsigned int cacheSize = 16);
+
+// `destination` may be `indices`
+void optimizeVertexCache(std::uint32_t *destination, const std::uint32_t *indices,
+                         std::size_t indexCount, std::size_t vertexCount);
+
+// `positions` is a float x, y, z every `positionStride` floats, one per vertex; a cluster may
+// cost up to `threshold` times the ACMR of the order it came from
+void optimizeOverdraw(std::uint32_t *destination, const std::uint32_t *indices,
+                      std::size_t indexCount, const float *positions, std::size_t positionStride,
+                      std::size_t vertexCount, float threshold = 1.05f);
+
+// reorders `vertices` (`floatsPerVertex` floats each) and renumbers `indices` to match, in
+// place; returns the new vertex count
+std::size_t optimizeVertexFetch(float *vertices, std::uint32_t *indices, std::size_t indexCount,
+                                std::size_t vertexCount, int floatsPerVertex);
+
+// all three with positions in each vertex's first three floats; resizes `vertices` to drop
+// the unreferenced ones
+void optimizeMesh(std::vector<float> &vertices, std::vector<std::uint32_t> &indices,
+                  int floatsPerVertex);
+#endif
@@ -0,0 +1,27 @@
+#ifndef OBJ_READER_H
+#define OBJ_READER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// A Wavefront OBJ as a triangle list of interleaved floats, one vertex per face corner, ready
+// to be welded by a MeshBuilder: position, then texture coordinates if any face has them,
+// then normals likewise (a corner without one gets zeros). Polygons are fanned into
+// triangles; materials, groups, lines and points are skipped.
+struct ObjMesh {
+  std::vector<float> vertices;
+  bool hasTexCoords;
+  bool hasNormals;
+
+  ObjMesh();
+  int floatsPerVertex() const;
+  // floats per attribute in the order above, e.g. {3, 2, 3}
+  std::vector<int> attributeSizes() const;
+  std::size_t vertexCount() const;
+};
+
+// both print the reason and return false on malformed input
+bool readObj(const std::string &path, ObjMesh &mesh);
+bool parseObj(const std::string &text, ObjMesh &mesh);
+#endif
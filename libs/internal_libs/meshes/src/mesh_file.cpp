@@ -0,0 +1,219 @@
+#include "mesh_file.h"
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+struct MeshFileHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t attributeCount;
+  std::uint32_t vertexStride;
+  std::uint32_t vertexCount;
+  std::uint32_t indexType;
+  std::uint32_t indexCount;
+  std::uint32_t reserved;
+  float boundsMin[3];
+  float boundsMax[3];
+  std::uint64_t vertexOffset;  // from the start of the file
+  std::uint64_t indexOffset;
+};
+const char MESH_FILE_MAGIC[4] = {'G', 'L', 'M', 'S'};
+const std::uint32_t MESH_FILE_VERSION = 1;
+// sections start on a boundary that suits both the page cache and SIMD copies
+const std::uint64_t MESH_FILE_ALIGNMENT = 64;
+// GL guarantees at least this many vertex attributes
+const std::uint32_t MAX_ATTRIBUTES = 16;
+
+// the GL enums this lib stores without pulling in a GL header
+const std::uint32_t GL_BYTE_VALUE = 0x1400;
+const std::uint32_t GL_UNSIGNED_BYTE_VALUE = 0x1401;
+const std::uint32_t GL_SHORT_VALUE = 0x1402;
+const std::uint32_t GL_UNSIGNED_SHORT_VALUE = 0x1403;
+const std::uint32_t GL_UNSIGNED_INT_VALUE = 0x1405;
+const std::uint32_t GL_FLOAT_VALUE = 0x1406;
+const std::uint32_t GL_HALF_FLOAT_VALUE = 0x140B;
+const std::uint32_t GL_INT_2_10_10_10_REV_VALUE = 0x8D9F;
+
+std::uint64_t indexTypeBytes(std::uint32_t indexType) {
+  if (indexType == GL_UNSIGNED_SHORT_VALUE) return 2;
+  if (indexType == GL_UNSIGNED_INT_VALUE) return 4;
+  return 0;
+}
+
+// bytes an attribute reads from each vertex, or 0 if GL wouldn't take it
+std::uint64_t attributeBytes(const MeshFileAttribute& attribute) {
+  if (attribute.components < 1 || attribute.components > 4) return 0;
+  switch (attribute.glType) {
+    case GL_BYTE_VALUE:
+    case GL_UNSIGNED_BYTE_VALUE:
+      return attribute.components;
+    case GL_SHORT_VALUE:
+    case GL_UNSIGNED_SHORT_VALUE:
+    case GL_HALF_FLOAT_VALUE:
+      return 2 * attribute.components;
+    case GL_FLOAT_VALUE:
+      return 4 * attribute.components;
+    case GL_INT_2_10_10_10_REV_VALUE:
+      return attribute.components == 4 ? 4 : 0;
+    default:
+      return 0;
+  }
+}
+
+std::uint64_t align(std::uint64_t offset) {
+  return (offset + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+MeshFile::MeshFile()
+    : stride(0),
+      vertices(0),
+      type(0),
+      indices(0),
+      vertexBytes(nullptr),
+      indexBytes(nullptr),
+      minimum{0.0f, 0.0f, 0.0f},
+      maximum{0.0f, 0.0f, 0.0f} {}
+// ------------------------------------------------------------------------
+MeshFile MeshFile::open(const std::string& path) {
+  MeshFile result;
+  result.file = MappedFile(path);
+  if (result.file.isOpen()) result.parse(result.file.data(), result.file.size());
+  return result;
+}
+// ------------------------------------------------------------------------
+MeshFile MeshFile::fromMemory(const void* data, std::size_t size) {
+  MeshFile result;
+  result.parse((const unsigned char*)data, size);
+  return result;
+}
+// only the header and the attribute table are read; the sections are checked to lie inside
+// the file and then left for the GL to copy
+// ------------------------------------------------------------------------
+void MeshFile::parse(const unsigned char* bytes, std::size_t size) {
+  if (size < sizeof(MeshFileHeader) ||
+      std::memcmp(bytes, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) != 0) {
+    return;
+  }
+  MeshFileHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  std::uint64_t indexSize = (std::uint64_t)header.indexCount * indexTypeBytes(header.indexType);
+  std::uint64_t vertexSize = (std::uint64_t)header.vertexCount * header.vertexStride;
+  std::uint64_t tableEnd =
+      sizeof(MeshFileHeader) + (std::uint64_t)header.attributeCount * sizeof(MeshFileAttribute);
+  if (header.version != MESH_FILE_VERSION || header.attributeCount == 0 ||
+      header.attributeCount > MAX_ATTRIBUTES || indexTypeBytes(header.indexType) == 0 ||
+      header.indexCount == 0 || header.vertexCount == 0 || header.vertexStride == 0) {
+    return;
+  }
+  // a section that runs past the end would have glBufferData read past the mapping
+  if (tableEnd > header.vertexOffset || header.vertexOffset > size ||
+      vertexSize > size - header.vertexOffset || header.indexOffset > size ||
+      indexSize > size - header.indexOffset) {
+    return;
+  }
+  std::vector<MeshFileAttribute> table(header.attributeCount);
+  std::memcpy(table.data(), bytes + sizeof(MeshFileHeader),
+              table.size() * sizeof(MeshFileAttribute));
+  for (const MeshFileAttribute& attribute : table) {
+    std::uint64_t attributeSize = attributeBytes(attribute);
+    if (attribute.location >= MAX_ATTRIBUTES || attributeSize == 0 ||
+        attribute.offset + attributeSize > header.vertexStride) {
+      return;
+    }
+  }
+  attributeList.swap(table);
+  stride = header.vertexStride;
+  vertices = header.vertexCount;
+  type = header.indexType;
+  indices = header.indexCount;
+  vertexBytes = bytes + header.vertexOffset;
+  indexBytes = bytes + header.indexOffset;
+  std::memcpy(minimum, header.boundsMin, sizeof(minimum));
+  std::memcpy(maximum, header.boundsMax, sizeof(maximum));
+}
+// ------------------------------------------------------------------------
+bool MeshFile::valid() const { return vertexBytes != nullptr; }
+
+const std::vector<MeshFileAttribute>& MeshFile::attributes() const { return attributeList; }
+
+std::uint32_t MeshFile::vertexStride() const { return stride; }
+
+std::uint32_t MeshFile::vertexCount() const { return vertices; }
+
+const unsigned char* MeshFile::vertexData() const { return vertexBytes; }
+
+std::size_t MeshFile::vertexDataSize() const { return (std::size_t)vertices * stride; }
+
+std::uint32_t MeshFile::indexType() const { return type; }
+
+std::uint32_t MeshFile::indexCount() const { return indices; }
+
+const unsigned char* MeshFile::indexData() const { return indexBytes; }
+
+std::size_t MeshFile::indexDataSize() const {
+  return (std::size_t)(indices * indexTypeBytes(type));
+}
+
+const float* MeshFile::boundsMin() const { return minimum; }
+
+const float* MeshFile::boundsMax() const { return maximum; }
+// ------------------------------------------------------------------------
+bool MeshFile::write(const std::string& path, const std::vector<MeshFileAttribute>& attributes,
+                     std::uint32_t vertexStride, std::uint32_t vertexCount,
+                     const void* vertexData, std::uint32_t indexType, std::uint32_t indexCount,
+                     const void* indexData, const float boundsMin[3],
+                     const float boundsMax[3]) {
+  if (attributes.empty() || attributes.size() > MAX_ATTRIBUTES ||
+      indexTypeBytes(indexType) == 0) {
+    return false;
+  }
+  static std::atomic<unsigned int> counter(0);
+  std::string tempPath = path + ".tmp" + std::to_string(counter++);
+
+  MeshFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(header.magic));
+  header.version = MESH_FILE_VERSION;
+  header.attributeCount = (std::uint32_t)attributes.size();
+  header.vertexStride = vertexStride;
+  header.vertexCount = vertexCount;
+  header.indexType = indexType;
+  header.indexCount = indexCount;
+  std::memcpy(header.boundsMin, boundsMin, sizeof(header.boundsMin));
+  std::memcpy(header.boundsMax, boundsMax, sizeof(header.boundsMax));
+  std::uint64_t tableEnd = sizeof(MeshFileHeader) + attributes.size() * sizeof(MeshFileAttribute);
+  std::uint64_t vertexSize = (std::uint64_t)vertexCount * vertexStride;
+  header.vertexOffset = align(tableEnd);
+  header.indexOffset = align(header.vertexOffset + vertexSize);
+  std::uint64_t indexSize = (std::uint64_t)indexCount * indexTypeBytes(indexType);
+
+  std::error_code error;
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    const char padding[MESH_FILE_ALIGNMENT] = {};
+    out.write((const char*)&header, sizeof(header));
+    out.write((const char*)attributes.data(),
+              (std::streamsize)(attributes.size() * sizeof(MeshFileAttribute)));
+    out.write(padding, (std::streamsize)(header.vertexOffset - tableEnd));
+    out.write((const char*)vertexData, (std::streamsize)vertexSize);
+    out.write(padding, (std::streamsize)(header.indexOffset - header.vertexOffset - vertexSize));
+    out.write((const char*)indexData, (std::streamsize)indexSize);
+    if (!out) {
+      out.close();
+      std::filesystem::remove(tempPath, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(tempPath, path, error);
+  if (!error) return true;
+  std::filesystem::remove(tempPath, error);
+  return false;
+}
@@ -0,0 +1,340 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Forsyth's scoring: the cache he models is bigger than any real one on purpose, it only has
+// to rank vertices by how recently they were used
+const int SCORING_CACHE_SIZE = 32;
+const float CACHE_DECAY_POWER = 1.5f;
+const float LAST_TRIANGLE_SCORE = 0.75f;
+const float VALENCE_BOOST_SCALE = 2.0f;
+const float VALENCE_BOOST_POWER = 0.5f;
+// valence scores are tabled up to here; busier vertices all score the same boost
+const int MAX_TABLED_VALENCE = 64;
+
+struct ScoreTables {
+  float cache[SCORING_CACHE_SIZE];
+  float valence[MAX_TABLED_VALENCE];
+
+  ScoreTables() {
+    for (int i = 0; i < SCORING_CACHE_SIZE; i++) {
+      // the last triangle's three vertices score the same, so no single one of them is
+      // favoured to finish a strip
+      cache[i] = i < 3 ? LAST_TRIANGLE_SCORE
+                       : std::pow(1.0f - (float)(i - 3) / (SCORING_CACHE_SIZE - 3),
+                                  CACHE_DECAY_POWER);
+    }
+    valence[0] = 0.0f;
+    for (int i = 1; i < MAX_TABLED_VALENCE; i++) {
+      // few triangles left: finish the vertex off before it leaves the cache
+      valence[i] = VALENCE_BOOST_SCALE * std::pow((float)i, -VALENCE_BOOST_POWER);
+    }
+  }
+};
+
+float vertexScore(const ScoreTables& tables, int cachePosition, unsigned int liveTriangles) {
+  if (liveTriangles == 0) return -1.0f;
+  float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+  return score + tables.valence[std::min<unsigned int>(liveTriangles, MAX_TABLED_VALENCE - 1)];
+}
+
+struct Vec3 {
+  float x, y, z;
+};
+
+Vec3 position(const float* positions, std::size_t stride, std::uint32_t vertex) {
+  const float* p = positions + vertex * stride;
+  return {p[0], p[1], p[2]};
+}
+
+// a cluster of the overdraw pass: triangles [begin, end) and how early it should be drawn
+struct Cluster {
+  std::size_t begin;
+  std::size_t end;
+  float sortKey;
+};
+
+// FIFO cache simulation for the overdraw pass; `stamps` is per vertex and only grows
+class FifoCache {
+ public:
+  FifoCache(std::size_t vertexCount, unsigned int size)
+      : stamps(vertexCount, 0), size(size), time(size + 1) {}
+
+  // a cold cache, without touching every vertex: old stamps are simply too old
+  void reset() { time += size + 1; }
+
+  unsigned int misses(const std::uint32_t* triangle) {
+    unsigned int count = 0;
+    for (int i = 0; i < 3; i++) {
+      if (time - stamps[triangle[i]] > size) {
+        stamps[triangle[i]] = time++;
+        count++;
+      }
+    }
+    return count;
+  }
+
+ private:
+  std::vector<std::size_t> stamps;
+  std::size_t size;
+  std::size_t time;
+};
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+VertexCacheStats analyzeVertexCache(const std::uint32_t* indices, std::size_t indexCount,
+                                    std::size_t vertexCount, unsigned int cacheSize) {
+  VertexCacheStats stats = {0, 0.0f, 0.0f};
+  std::size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0 || cacheSize == 0) return stats;
+  // a vertex is cached while fewer than cacheSize misses came after its own
+  std::vector<std::size_t> stamps(vertexCount, 0);
+  std::vector<bool> referenced(vertexCount, false);
+  std::size_t time = cacheSize + 1;
+  std::size_t referencedCount = 0;
+  for (std::size_t i = 0; i < triangleCount * 3; i++) {
+    std::uint32_t vertex = indices[i];
+    if (time - stamps[vertex] > cacheSize) {
+      stamps[vertex] = time++;
+      stats.transformedVertices++;
+    }
+    if (!referenced[vertex]) {
+      referenced[vertex] = true;
+      referencedCount++;
+    }
+  }
+  stats.acmr = (float)stats.transformedVertices / triangleCount;
+  stats.atvr = (float)stats.transformedVertices / referencedCount;
+  return stats;
+}
+// Greedy: emit the best scoring triangle, rescore only what the cache touched, repeat. Scores
+// sum the three vertices' scores, which favour vertices used recently (in the cache) and
+// vertices with few triangles left (so they aren't stranded).
+// ------------------------------------------------------------------------
+void optimizeVertexCache(std::uint32_t* destination, const std::uint32_t* indices,
+                         std::size_t indexCount, std::size_t vertexCount) {
+  static const ScoreTables tables;
+  std::size_t triangleCount = indexCount / 3;
+  std::vector<std::uint32_t> result(indices, indices + indexCount);
+  if (triangleCount == 0) return;
+
+  // triangles of each vertex, packed; the first liveTriangles[v] of a vertex's are unemitted
+  std::vector<unsigned int> liveTriangles(vertexCount, 0);
+  for (std::size_t i = 0; i < triangleCount * 3; i++) liveTriangles[indices[i]]++;
+  std::vector<std::size_t> adjacencyStart(vertexCount + 1, 0);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    adjacencyStart[v + 1] = adjacencyStart[v] + liveTriangles[v];
+  }
+  std::vector<std::uint32_t> adjacency(triangleCount * 3);
+  {
+    std::vector<std::size_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (std::size_t t = 0; t < triangleCount; t++) {
+      for (int k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = (std::uint32_t)t;
+    }
+  }
+
+  std::vector<float> scores(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    scores[v] = vertexScore(tables, -1, liveTriangles[v]);
+  }
+  std::vector<bool> emitted(triangleCount, false);
+  std::size_t best = 0;
+  float bestScore = -1.0f;
+  for (std::size_t t = 0; t < triangleCount; t++) {
+    const std::uint32_t* triangle = indices + t * 3;
+    float score = scores[triangle[0]] + scores[triangle[1]] + scores[triangle[2]];
+    if (score > bestScore) {
+      bestScore = score;
+      best = t;
+    }
+  }
+
+  // the cache after an emit holds the triangle's three vertices and then the previous cache
+  std::vector<std::uint32_t> cache, nextCache;
+  cache.reserve(SCORING_CACHE_SIZE + 3);
+  nextCache.reserve(SCORING_CACHE_SIZE + 3);
+  // where to look when nothing in the cache has triangles left
+  std::size_t deadEndCursor = 0;
+  for (std::size_t out = 0; out < triangleCount; out++) {
+    const std::uint32_t* triangle = indices + best * 3;
+    std::copy(triangle, triangle + 3, result.begin() + out * 3);
+    emitted[best] = true;
+
+    nextCache.assign(triangle, triangle + 3);
+    for (int k = 0; k < 3; k++) {
+      std::uint32_t vertex = triangle[k];
+      // swap the triangle past the end of the vertex's live ones
+      std::uint32_t* live = &adjacency[adjacencyStart[vertex]];
+      unsigned int& count = liveTriangles[vertex];
+      for (unsigned int i = 0; i < count; i++) {
+        if (live[i] == best) {
+          std::swap(live[i], live[count - 1]);
+          count--;
+          break;
+        }
+      }
+    }
+    for (std::uint32_t vertex : cache) {
+      if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2]) {
+        nextCache.push_back(vertex);
+      }
+    }
+    cache.swap(nextCache);
+
+    for (std::size_t i = 0; i < cache.size(); i++) {
+      // the (up to) three vertices pushed past the end leave the cache
+      int position = i < (std::size_t)SCORING_CACHE_SIZE ? (int)i : -1;
+      scores[cache[i]] = vertexScore(tables, position, liveTriangles[cache[i]]);
+    }
+    bestScore = -1.0f;
+    best = triangleCount;
+    for (std::uint32_t vertex : cache) {
+      const std::uint32_t* live = &adjacency[adjacencyStart[vertex]];
+      for (unsigned int i = 0; i < liveTriangles[vertex]; i++) {
+        const std::uint32_t* t = indices + live[i] * 3;
+        float score = scores[t[0]] + scores[t[1]] + scores[t[2]];
+        if (score > bestScore) {
+          bestScore = score;
+          best = live[i];
+        }
+      }
+    }
+    if (cache.size() > (std::size_t)SCORING_CACHE_SIZE) cache.resize(SCORING_CACHE_SIZE);
+
+    if (best == triangleCount) {
+      // a dead end: carry on from the first triangle not yet drawn
+      while (deadEndCursor < triangleCount && emitted[deadEndCursor]) deadEndCursor++;
+      best = deadEndCursor;
+    }
+  }
+  std::copy(result.begin(), result.end(), destination);
+}
+// Splits the order into clusters wherever the cache is cold anyway (a triangle of three
+// misses) and again wherever a cluster's running ACMR is within `threshold` of its whole
+// run's, then sorts the clusters by how far they face away from the mesh's centre.
+// ------------------------------------------------------------------------
+void optimizeOverdraw(std::uint32_t* destination, const std::uint32_t* indices,
+                      std::size_t indexCount, const float* positions, std::size_t positionStride,
+                      std::size_t vertexCount, float threshold) {
+  const unsigned int cacheSize = 16;
+  std::size_t triangleCount = indexCount / 3;
+  if (triangleCount == 0) return;
+
+  FifoCache cache(vertexCount, cacheSize);
+  std::vector<std::size_t> hardBoundaries;
+  for (std::size_t t = 0; t < triangleCount; t++) {
+    if (cache.misses(indices + t * 3) == 3 || t == 0) hardBoundaries.push_back(t);
+  }
+  hardBoundaries.push_back(triangleCount);
+
+  std::vector<Cluster> clusters;
+  for (std::size_t h = 0; h + 1 < hardBoundaries.size(); h++) {
+    std::size_t begin = hardBoundaries[h], end = hardBoundaries[h + 1];
+    cache.reset();
+    std::size_t misses = 0;
+    for (std::size_t t = begin; t < end; t++) misses += cache.misses(indices + t * 3);
+    float target = threshold * (float)misses / (float)(end - begin);
+
+    cache.reset();
+    std::size_t clusterBegin = begin;
+    std::size_t clusterMisses = 0;
+    for (std::size_t t = begin; t < end; t++) {
+      clusterMisses += cache.misses(indices + t * 3);
+      if ((float)clusterMisses / (float)(t + 1 - clusterBegin) <= target || t + 1 == end) {
+        clusters.push_back({clusterBegin, t + 1, 0.0f});
+        clusterBegin = t + 1;
+        clusterMisses = 0;
+        cache.reset();
+      }
+    }
+  }
+
+  // area weighted, so big triangles count for what they cover
+  Vec3 meshCentre = {0.0f, 0.0f, 0.0f};
+  float meshArea = 0.0f;
+  std::vector<Vec3> clusterCentres(clusters.size()), clusterNormals(clusters.size());
+  for (std::size_t c = 0; c < clusters.size(); c++) {
+    Vec3 centre = {0.0f, 0.0f, 0.0f}, normal = {0.0f, 0.0f, 0.0f};
+    float area = 0.0f;
+    for (std::size_t t = clusters[c].begin; t < clusters[c].end; t++) {
+      Vec3 a = position(positions, positionStride, indices[t * 3]);
+      Vec3 b = position(positions, positionStride, indices[t * 3 + 1]);
+      Vec3 d = position(positions, positionStride, indices[t * 3 + 2]);
+      Vec3 e1 = {b.x - a.x, b.y - a.y, b.z - a.z}, e2 = {d.x - a.x, d.y - a.y, d.z - a.z};
+      Vec3 n = {e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x};
+      float triangleArea = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+      centre.x += (a.x + b.x + d.x) / 3.0f * triangleArea;
+      centre.y += (a.y + b.y + d.y) / 3.0f * triangleArea;
+      centre.z += (a.z + b.z + d.z) / 3.0f * triangleArea;
+      normal.x += n.x;
+      normal.y += n.y;
+      normal.z += n.z;
+      area += triangleArea;
+    }
+    meshCentre.x += centre.x;
+    meshCentre.y += centre.y;
+    meshCentre.z += centre.z;
+    meshArea += area;
+    float inverse = area > 0.0f ? 1.0f / area : 0.0f;
+    clusterCentres[c] = {centre.x * inverse, centre.y * inverse, centre.z * inverse};
+    float length = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+    float normalInverse = length > 0.0f ? 1.0f / length : 0.0f;
+    clusterNormals[c] = {normal.x * normalInverse, normal.y * normalInverse,
+                         normal.z * normalInverse};
+  }
+  if (meshArea > 0.0f) {
+    meshCentre = {meshCentre.x / meshArea, meshCentre.y / meshArea, meshCentre.z / meshArea};
+  }
+  // outward facing clusters far from the centre occlude the most, so they go first
+  for (std::size_t c = 0; c < clusters.size(); c++) {
+    Vec3 offset = {clusterCentres[c].x - meshCentre.x, clusterCentres[c].y - meshCentre.y,
+                   clusterCentres[c].z - meshCentre.z};
+    clusters[c].sortKey = offset.x * clusterNormals[c].x + offset.y * clusterNormals[c].y +
+                          offset.z * clusterNormals[c].z;
+  }
+  std::stable_sort(clusters.begin(), clusters.end(),
+                   [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+  std::vector<std::uint32_t> result;
+  result.reserve(triangleCount * 3);
+  for (const Cluster& cluster : clusters) {
+    result.insert(result.end(), indices + cluster.begin * 3, indices + cluster.end * 3);
+  }
+  std::copy(result.begin(), result.end(), destination);
+}
+// ------------------------------------------------------------------------
+std::size_t optimizeVertexFetch(float* vertices, std::uint32_t* indices, std::size_t indexCount,
+                                std::size_t vertexCount, int floatsPerVertex) {
+  const std::uint32_t UNUSED = 0xffffffffu;
+  std::vector<std::uint32_t> remap(vertexCount, UNUSED);
+  std::uint32_t next = 0;
+  for (std::size_t i = 0; i < indexCount; i++) {
+    std::uint32_t& target = remap[indices[i]];
+    if (target == UNUSED) target = next++;
+    indices[i] = target;
+  }
+  std::vector<float> original(vertices, vertices + vertexCount * floatsPerVertex);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    if (remap[v] == UNUSED) continue;
+    std::memcpy(vertices + remap[v] * floatsPerVertex, &original[v * floatsPerVertex],
+                floatsPerVertex * sizeof(float));
+  }
+  return next;
+}
+// ------------------------------------------------------------------------
+void optimizeMesh(std::vector<float>& vertices, std::vector<std::uint32_t>& indices,
+                  int floatsPerVertex) {
+  if (floatsPerVertex < 3 || indices.empty()) return;
+  std::size_t vertexCount = vertices.size() / floatsPerVertex;
+  optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount);
+  optimizeOverdraw(indices.data(), indices.data(), indices.size(), vertices.data(),
+                   floatsPerVertex, vertexCount);
+  vertexCount = optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertexCount,
+                                    floatsPerVertex);
+  vertices.resize(vertexCount * floatsPerVertex);
+}
@@ -0,0 +1,139 @@
+#include "obj_reader.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// one face corner; indices are 0-based, -1 when the corner has no such attribute
+struct ObjCorner {
+  long position;
+  long texCoord;
+  long normal;
+};
+
+// OBJ indices start at 1 and negative ones count back from the latest element
+bool resolveIndex(const char* text, std::size_t count, long& index) {
+  char* end = nullptr;
+  long value = std::strtol(text, &end, 10);
+  if (end == text) return false;
+  index = value < 0 ? (long)count + value : value - 1;
+  return index >= 0 && (std::size_t)index < count;
+}
+
+// "v", "v/t", "v//n" or "v/t/n"
+bool parseCorner(const std::string& token, std::size_t positions, std::size_t texCoords,
+                 std::size_t normals, ObjCorner& corner) {
+  corner.texCoord = corner.normal = -1;
+  std::size_t firstSlash = token.find('/');
+  if (!resolveIndex(token.c_str(), positions, corner.position)) return false;
+  if (firstSlash == std::string::npos) return true;
+  std::size_t secondSlash = token.find('/', firstSlash + 1);
+  if (secondSlash != firstSlash + 1) {
+    if (!resolveIndex(token.c_str() + firstSlash + 1, texCoords, corner.texCoord)) return false;
+  }
+  if (secondSlash != std::string::npos) {
+    if (!resolveIndex(token.c_str() + secondSlash + 1, normals, corner.normal)) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+ObjMesh::ObjMesh() : hasTexCoords(false), hasNormals(false) {}
+
+int ObjMesh::floatsPerVertex() const { return 3 + (hasTexCoords ? 2 : 0) + (hasNormals ? 3 : 0); }
+
+std::vector<int> ObjMesh::attributeSizes() const {
+  std::vector<int> sizes = {3};
+  if (hasTexCoords) sizes.push_back(2);
+  if (hasNormals) sizes.push_back(3);
+  return sizes;
+}
+
+std::size_t ObjMesh::vertexCount() const { return vertices.size() / floatsPerVertex(); }
+// ------------------------------------------------------------------------
+bool readObj(const std::string& path, ObjMesh& mesh) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    std::cout << "ERROR::OBJ::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+    return false;
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+  return parseObj(text.str(), mesh);
+}
+// ------------------------------------------------------------------------
+bool parseObj(const std::string& text, ObjMesh& mesh) {
+  std::vector<float> positions, texCoords, normals;
+  std::vector<ObjCorner> corners;
+  std::vector<ObjCorner> face;
+  std::istringstream lines(text);
+  std::string line, keyword, token;
+  std::size_t lineNumber = 0;
+  while (std::getline(lines, line)) {
+    lineNumber++;
+    std::istringstream fields(line);
+    if (!(fields >> keyword) || keyword[0] == '#') continue;
+    if (keyword == "v" || keyword == "vn") {
+      float x = 0.0f, y = 0.0f, z = 0.0f;
+      if (!(fields >> x >> y >> z)) {
+        std::cout << "ERROR::OBJ::BAD_VECTOR: line " << lineNumber << std::endl;
+        return false;
+      }
+      std::vector<float>& target = keyword == "v" ? positions : normals;
+      target.insert(target.end(), {x, y, z});
+    } else if (keyword == "vt") {
+      float u = 0.0f, v = 0.0f;
+      if (!(fields >> u)) {
+        std::cout << "ERROR::OBJ::BAD_TEXCOORD: line " << lineNumber << std::endl;
+        return false;
+      }
+      fields >> v;  // optional, like w
+      texCoords.insert(texCoords.end(), {u, v});
+    } else if (keyword == "f") {
+      face.clear();
+      while (fields >> token) {
+        ObjCorner corner;
+        if (!parseCorner(token, positions.size() / 3, texCoords.size() / 2, normals.size() / 3,
+                         corner)) {
+          std::cout << "ERROR::OBJ::BAD_FACE_INDEX: line " << lineNumber << std::endl;
+          return false;
+        }
+        face.push_back(corner);
+      }
+      // a fan around the first corner
+      for (std::size_t i = 2; i < face.size(); i++) {
+        corners.push_back(face[0]);
+        corners.push_back(face[i - 1]);
+        corners.push_back(face[i]);
+      }
+    }
+  }
+
+  mesh.hasTexCoords = mesh.hasNormals = false;
+  for (const ObjCorner& corner : corners) {
+    mesh.hasTexCoords = mesh.hasTexCoords || corner.texCoord >= 0;
+    mesh.hasNormals = mesh.hasNormals || corner.normal >= 0;
+  }
+  mesh.vertices.clear();
+  mesh.vertices.reserve(corners.size() * mesh.floatsPerVertex());
+  for (const ObjCorner& corner : corners) {
+    const float* p = &positions[corner.position * 3];
+    mesh.vertices.insert(mesh.vertices.end(), p, p + 3);
+    if (mesh.hasTexCoords) {
+      const float zero[2] = {0.0f, 0.0f};
+      const float* t = corner.texCoord >= 0 ? &texCoords[corner.texCoord * 2] : zero;
+      mesh.vertices.insert(mesh.vertices.end(), t, t + 2);
+    }
+    if (mesh.hasNormals) {
+      const float zero[3] = {0.0f, 0.0f, 0.0f};
+      const float* n = corner.normal >= 0 ? &normals[corner.normal * 3] : zero;
+      mesh.vertices.insert(mesh.vertices.end(), n, n + 3);
+    }
+  }
+  return true;
+}
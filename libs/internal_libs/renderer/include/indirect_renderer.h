@@ -0,0 +1,113 @@
+#ifndef INDIRECT_RENDERER_H
+#define INDIRECT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <mesh_file.h>
+#include <stream_buffer.h>
+
+#include "mesh.h"
+#include "vertex_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+};
+
+// Draws many objects of many different meshes in one call. Every mesh added goes into one
+// shared vertex buffer and one shared 32-bit index buffer (the "mega-buffers", which grow
+// as needed), all in the same VertexFormat behind one VAO. Each frame the objects drawn
+// between begin() and submit() are grouped by mesh, their model matrices streamed into an
+// instance array (a mat4 at `firstInstanceLocation`, like InstancedRenderer's) and one
+// DrawElementsIndirectCommand recorded per mesh, so
+//   - with multi-draw indirect, the commands go into the same StreamBuffer and the whole
+//     frame is a single glMultiDrawElementsIndirect;
+//   - without it (GL 3.3), a CPU loop issues each command with
+//     glDrawElementsInstancedBaseVertex, re-pointing the instance array at the command's
+//     objects instead of relying on baseInstance: one draw per mesh, not per object.
+//
+//   IndirectRenderer scene(format);
+//   IndirectRenderer::MeshHandle cube = scene.addMesh(cubeFile);
+//   scene.begin();
+//   scene.draw(cube, model);
+//   scene.submit();
+class IndirectRenderer {
+ public:
+  typedef int MeshHandle;
+
+  unsigned int VAO;
+  unsigned int VBO;
+  unsigned int EBO;
+
+  // GL thread; every mesh must have `format`'s attributes, which take locations from 0, so
+  // the instance matrix's four locations must come after them
+  explicit IndirectRenderer(const VertexFormat &format, unsigned int firstInstanceLocation = 2);
+  IndirectRenderer(const IndirectRenderer &) = delete;
+  IndirectRenderer &operator=(const IndirectRenderer &) = delete;
+
+  // append a mesh to the mega-buffers; -1 (and a message) if it isn't in the format
+  MeshHandle addMesh(const MeshBuilder &builder);
+  MeshHandle addMesh(const MeshFile &file);
+  std::size_t meshCount() const;
+
+  void begin();
+  void draw(MeshHandle mesh, const glm::mat4 &model);
+  // uploads the frame's matrices and commands and draws everything with the shader in use
+  void submit(GLenum mode = GL_TRIANGLES);
+
+  // whether submit() uses glMultiDrawElementsIndirect
+  bool indirect() const;
+  // of the last submit()
+  std::size_t objectCount() const;
+  std::size_t commandCount() const;
+  std::size_t drawCalls() const;
+  const StreamBuffer &stream() const;
+
+  // GL thread: deletes the VAO, the mega-buffers and the stream
+  void release();
+
+ private:
+  struct MeshRange {
+    std::uint32_t firstIndex;
+    std::uint32_t indexCount;
+    std::int32_t baseVertex;
+  };
+  struct Object {
+    MeshHandle mesh;
+    glm::mat4 model;
+  };
+
+  VertexFormat vertexFormat;
+  unsigned int instanceLocation;
+  bool multiDraw;
+  std::vector<MeshRange> meshes;
+  // used and allocated bytes of the mega-buffers
+  std::size_t vertexBytes;
+  std::size_t vertexCapacity;
+  std::size_t indexBytes;
+  std::size_t indexCapacity;
+  std::unique_ptr<StreamBuffer> frameStream;
+  std::vector<Object> objects;
+  std::vector<glm::mat4> instances;
+  std::vector<DrawElementsIndirectCommand> commands;
+  // per mesh: objects drawn this frame, then where its instances start
+  std::vector<std::uint32_t> meshInstances;
+  std::size_t draws;
+
+  MeshHandle appendMesh(const void *vertices, std::size_t vertexCount, const void *indices,
+                        std::size_t indexCount, GLenum indexType);
+  void growBuffer(GLenum target, unsigned int &buffer, std::size_t used, std::size_t &capacity,
+                  std::size_t needed);
+  void attachStream(std::size_t frameSize);
+  void pointInstances(std::size_t offset);
+};
+#endif
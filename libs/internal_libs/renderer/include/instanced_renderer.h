@@ -0,0 +1,58 @@
+#ifndef INSTANCED_RENDERER_H
+#define INSTANCED_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <stream_buffer.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Draws many copies of one mesh with a single glDraw{Arrays,Elements}Instanced. Each
+// instance's model matrix is attached to the mesh's VAO as a mat4 attribute (four vec4
+// columns at consecutive locations, divisor 1), so the vertex shader declares
+//   layout (location = 2) in mat4 aModel;
+// and nothing is uploaded per draw. The matrices live in a StreamBuffer: every change
+// writes the whole set into the ring's next region and points the attribute there, so
+// updating instances every frame never reallocates or waits on draws still in flight.
+class InstancedRenderer {
+ public:
+  // GL thread; `vao` is the mesh to repeat; locations firstLocation..firstLocation+3 must be
+  // free in it
+  InstancedRenderer(unsigned int vao, unsigned int firstLocation = 2);
+  InstancedRenderer(const InstancedRenderer &) = delete;
+  InstancedRenderer &operator=(const InstancedRenderer &) = delete;
+
+  // replaces all instances; the ring only reallocates when it has to grow
+  void setInstances(const glm::mat4 *transforms, std::size_t count);
+  // overwrites instances [first, first + count); the whole set is streamed again
+  void updateInstances(std::size_t first, const glm::mat4 *transforms, std::size_t count);
+  std::size_t instanceCount() const;
+
+  // one draw call for every instance
+  void draw(GLenum mode, int firstVertex, int vertexCount) const;
+  // the same through the index buffer bound to the VAO, e.g. a Mesh's
+  void drawElements(GLenum mode, int indexCount, GLenum indexType) const;
+  // one draw call per instance with the matrix set as a constant attribute; the same result
+  // as draw(), for measuring what instancing saves
+  void drawUnbatched(GLenum mode, int firstVertex, int vertexCount) const;
+  void drawElementsUnbatched(GLenum mode, int indexCount, GLenum indexType) const;
+
+  const StreamBuffer &stream() const;
+  // GL thread: deletes the instance stream; the VAO stays the mesh's
+  void release();
+
+ private:
+  unsigned int vao;
+  unsigned int location;
+  std::unique_ptr<StreamBuffer> instanceStream;
+  // CPU copy, streamed on every change and read by drawUnbatched
+  std::vector<glm::mat4> instances;
+
+  void upload();
+  void pointInstances(std::size_t offset);
+  void setInstanceArraysEnabled(bool enabled) const;
+};
+#endif
@@ -0,0 +1,97 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <glad/glad.h>
+
+#include <mesh_file.h>
+
+#include "vertex_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// An indexed triangle mesh on the GPU: one interleaved VBO in some VertexFormat (plain floats
+// unless the builder was given one), an index buffer and the VAO that ties them together.
+// Attribute i sits at location i, in the order the builder was given them. 16-bit indices
+// are used whenever the vertices fit, halving the index buffer. Like the other GL wrappers
+// here it's a handle: copies share the objects and release() deletes them.
+class Mesh {
+ public:
+  unsigned int VAO;
+  unsigned int VBO;
+  unsigned int EBO;
+
+  Mesh();
+  // GL thread: uploads a cooked mesh's sections as they are; the file can be closed after
+  static Mesh fromFile(const MeshFile &file, GLenum usage = GL_STATIC_DRAW);
+
+  std::size_t vertexCount() const;
+  // size of the vertex buffer
+  std::size_t vertexBytes() const;
+  std::size_t indexCount() const;
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+  GLenum indexType() const;
+
+  void draw(GLenum mode = GL_TRIANGLES) const;
+
+  // GL thread: deletes the VAO and both buffers
+  void release();
+
+ private:
+  friend class MeshBuilder;
+
+  std::size_t vertices;
+  std::size_t bytes;
+  std::size_t indices;
+  GLenum type;
+};
+
+// Collects vertices and welds the bitwise-identical ones (after folding -0 into 0) through a
+// hash of their components, so a triangle soup such as the apps' 36-vertex cube comes out as
+// 36 indices into at most 24 vertices (16 there, as some faces also share texture
+// coordinates at their corners). Each vertex is `floatsPerVertex()` interleaved floats.
+//
+//   MeshBuilder builder({3, 2});  // position, texture coordinates
+//   builder.addTriangles(vertices, 36);
+//   Mesh cube = builder.build();
+class MeshBuilder {
+ public:
+  // floats in each attribute, in location order
+  explicit MeshBuilder(const std::vector<int> &attributeSizes);
+
+  int floatsPerVertex() const;
+  std::size_t vertexCount() const;
+  // size of the vertex buffer build() makes, as floats
+  std::size_t vertexBytes() const;
+  std::size_t indexCount() const;
+  const std::vector<float> &vertices() const;
+  const std::vector<std::uint32_t> &indices() const;
+
+  // the index of `vertex`, appending it only if an identical one isn't there yet
+  std::uint32_t addVertex(const float *vertex);
+  // `count` vertices of a non-indexed triangle list, welded as they come
+  void addTriangles(const float *vertices, std::size_t count);
+  // one triangle of vertices already added
+  void addTriangle(std::uint32_t a, std::uint32_t b, std::uint32_t c);
+  void clear();
+
+  // GL thread: uploads what has been built so far as floats, or packed into `format`, whose
+  // attributes must have the components the builder was given
+  Mesh build(GLenum usage = GL_STATIC_DRAW) const;
+  Mesh build(const VertexFormat &format, GLenum usage = GL_STATIC_DRAW) const;
+
+ private:
+  std::vector<int> attributes;
+  int stride;
+  std::vector<float> vertexData;
+  std::vector<std::uint32_t> indexData;
+  // open addressing over vertex indices; EMPTY_SLOT marks a free slot
+  std::vector<std::uint32_t> slots;
+  // addVertex()'s copy of the vertex it's looking up
+  std::vector<float> key;
+
+  std::uint32_t hashVertex(const float *vertex) const;
+  void rehash(std::size_t slotCount);
+};
+#endif
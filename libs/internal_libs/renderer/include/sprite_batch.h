@@ -0,0 +1,78 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <stream_buffer.h>
+#include <texture_region.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Collects 2D quads between begin() and end() and draws them with one call per texture.
+// Every quad is four vertices written straight into a StreamBuffer, sharing a static index
+// buffer, so a frame of thousands of sprites costs one copy and a handful of draws, and
+// never reallocates or syncs with the GPU unless the frame outgrows the buffer.
+// The vertex shader reads
+//   layout (location = 0) in vec2 aPos;       // as passed to draw()
+//   layout (location = 1) in vec3 aTexCoord;  // u, v and the texture array layer
+//   layout (location = 2) in vec4 aColor;     // tint, 0..1
+// and the shader in use when end() is called draws every bucket. Buckets keep the order
+// their texture was first drawn in and quads keep their order within a bucket; quads of
+// different textures don't interleave, so pack textures that overlap into one TextureAtlas
+// or TextureArray to keep their draw order.
+class SpriteBatch {
+ public:
+  unsigned int VAO;
+  unsigned int EBO;
+
+  // quads per draw call; a bucket with more is split (16-bit indices cap it at 16384)
+  explicit SpriteBatch(std::size_t quadsPerDraw = 16384);
+  SpriteBatch(const SpriteBatch &) = delete;
+  SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+  void begin();
+  // a size.x by size.y quad centred on `center`, showing `region` of a GL_TEXTURE_2D or
+  // GL_TEXTURE_2D_ARRAY texture; texture 0 collects untextured quads, for shaders that only
+  // use the colour
+  void draw(GLenum target, unsigned int texture, const glm::vec2 &center, const glm::vec2 &size,
+            const TextureRegion &region = {}, const glm::vec4 &color = glm::vec4(1.0f));
+  // uploads everything and draws it, binding each texture on the active unit
+  void end();
+
+  // of the last end()
+  std::size_t quadCount() const;
+  std::size_t drawCalls() const;
+  const StreamBuffer &stream() const;
+
+  // GL thread: deletes the VAO and the buffers
+  void release();
+
+ private:
+  struct Vertex {
+    float x, y;
+    float u, v, layer;
+    std::uint8_t color[4];
+  };
+  struct Bucket {
+    GLenum target;
+    unsigned int texture;
+    std::vector<Vertex> vertices;
+  };
+
+  std::size_t quadsPerDraw;
+  std::unique_ptr<StreamBuffer> vertexStream;
+  // buckets stay allocated between frames; only the first `usedBuckets` are live
+  std::vector<Bucket> buckets;
+  std::size_t usedBuckets;
+  std::size_t lastBucket;
+  std::size_t quads;
+  std::size_t draws;
+
+  Bucket &bucketFor(GLenum target, unsigned int texture);
+  void attachStream(std::size_t frameSize);
+};
+#endif
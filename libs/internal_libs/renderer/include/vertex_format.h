@@ -0,0 +1,75 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// How each attribute is stored in the vertex buffer. The vertex shader still reads floats:
+// the normalized types come out in [0, 1] or [-1, 1], half floats as they went in.
+enum class VertexAttributeType {
+  // GL_FLOAT, 4 bytes a component
+  Float,
+  // GL_HALF_FLOAT, 2 bytes; 11 significant bits, fine for model-space positions
+  HalfFloat,
+  // GL_SHORT / GL_UNSIGNED_SHORT normalized, 2 bytes; unsigned suits texture coordinates
+  Snorm16,
+  Unorm16,
+  // GL_BYTE / GL_UNSIGNED_BYTE normalized, 1 byte; unsigned suits colours
+  Snorm8,
+  Unorm8,
+  // GL_INT_2_10_10_10_REV normalized, 4 bytes for up to 4 components: unit normals
+  Snorm10_10_10_2,
+};
+
+// An interleaved vertex layout: attribute i at location i, each starting on a 4 byte
+// boundary as GL prefers. pack() converts vertices given as plain interleaved floats (the
+// attributes' components in order, as MeshBuilder holds them) into this layout, and apply()
+// points the bound VAO at a buffer of them.
+//
+//   VertexFormat format;
+//   format.add(VertexAttributeType::HalfFloat, 3).add(VertexAttributeType::Unorm16, 2);
+//   // 12 bytes a vertex instead of 20
+class VertexFormat {
+ public:
+  struct Attribute {
+    VertexAttributeType type;
+    int components;
+    std::size_t offset;
+  };
+
+  VertexFormat();
+  // all GL_FLOAT, one attribute per entry of `componentCounts`
+  static VertexFormat floats(const std::vector<int> &componentCounts);
+
+  VertexFormat &add(VertexAttributeType type, int components);
+
+  const std::vector<Attribute> &attributes() const;
+  // bytes per vertex in this layout
+  std::size_t stride() const;
+  // floats per vertex that pack() reads
+  int floatsPerVertex() const;
+  // what the same vertices take as plain floats, less what they take here
+  std::size_t bytesSaved(std::size_t vertexCount) const;
+
+  // the arguments glVertexAttribPointer takes for attribute i
+  GLint glComponents(std::size_t attribute) const;
+  GLenum glType(std::size_t attribute) const;
+  GLboolean glNormalized(std::size_t attribute) const;
+
+  std::vector<unsigned char> pack(const float *vertices, std::size_t vertexCount) const;
+  // glVertexAttribPointer and glEnableVertexAttribArray for every attribute, reading the
+  // buffer bound to GL_ARRAY_BUFFER from `baseOffset`
+  void apply(std::size_t baseOffset = 0) const;
+
+ private:
+  std::vector<Attribute> attributeList;
+  std::size_t vertexStride;
+  int floatCount;
+};
+
+// IEEE half with round to nearest even; overflow saturates to infinity
+std::uint16_t floatToHalf(float value);
+#endif
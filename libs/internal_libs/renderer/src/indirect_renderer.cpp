@@ -0,0 +1,261 @@
+#include "indirect_renderer.h"
+#include <gl_ext.h>
+#include <gl_state.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// room for a few meshes and a thousand objects before anything has to grow
+const std::size_t INITIAL_VERTEX_BYTES = 64 << 10;
+const std::size_t INITIAL_INDEX_BYTES = 64 << 10;
+const std::size_t INITIAL_OBJECTS = 1024;
+// the streamed instances start on a whole matrix so their offset is an instance index
+const std::size_t INSTANCE_BYTES = sizeof(glm::mat4);
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+IndirectRenderer::IndirectRenderer(const VertexFormat& format, unsigned int firstInstanceLocation)
+    : VAO(0),
+      VBO(0),
+      EBO(0),
+      vertexFormat(format),
+      instanceLocation(firstInstanceLocation),
+      multiDraw(glExtensions().multiDrawIndirect),
+      vertexBytes(0),
+      vertexCapacity(INITIAL_VERTEX_BYTES),
+      indexBytes(0),
+      indexCapacity(INITIAL_INDEX_BYTES),
+      draws(0) {
+  glGenVertexArrays(1, &VAO);
+  glGenBuffers(1, &VBO);
+  glGenBuffers(1, &EBO);
+  glState().bindVertexArray(VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, VBO);
+  glBufferData(GL_ARRAY_BUFFER, vertexCapacity, NULL, GL_STATIC_DRAW);
+  vertexFormat.apply();
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCapacity, NULL, GL_STATIC_DRAW);
+  glState().bindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  attachStream(INITIAL_OBJECTS * (INSTANCE_BYTES + sizeof(DrawElementsIndirectCommand)));
+}
+// a new ring for the per-frame data, and the VAO's instance array pointed at it
+// ------------------------------------------------------------------------
+void IndirectRenderer::attachStream(std::size_t frameSize) {
+  if (frameStream) frameStream->release();
+  frameStream.reset(new StreamBuffer(frameSize));
+  glState().bindVertexArray(VAO);
+  pointInstances(0);
+  for (unsigned int column = 0; column < 4; column++) {
+    glEnableVertexAttribArray(instanceLocation + column);
+    glVertexAttribDivisor(instanceLocation + column, 1);
+  }
+  glState().bindVertexArray(0);
+}
+// the VAO must be bound
+// ------------------------------------------------------------------------
+void IndirectRenderer::pointInstances(std::size_t offset) {
+  glBindBuffer(GL_ARRAY_BUFFER, frameStream->ID);
+  for (unsigned int column = 0; column < 4; column++) {
+    glVertexAttribPointer(instanceLocation + column, 4, GL_FLOAT, GL_FALSE, INSTANCE_BYTES,
+                          (void*)(offset + column * sizeof(glm::vec4)));
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// Reallocates `buffer` when `needed` more bytes don't fit, copying what it holds on the GPU
+// and pointing the VAO at the new one. Doubling keeps the copies rare while meshes load.
+// ------------------------------------------------------------------------
+void IndirectRenderer::growBuffer(GLenum target, unsigned int& buffer, std::size_t used,
+                                  std::size_t& capacity, std::size_t needed) {
+  if (used + needed <= capacity) return;
+  capacity = std::max(capacity * 2, used + needed);
+  unsigned int grown = 0;
+  glGenBuffers(1, &grown);
+  // the copy targets leave the VAO's bindings alone until it's pointed at the new buffer
+  glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+  glBufferData(GL_COPY_WRITE_BUFFER, capacity, NULL, GL_STATIC_DRAW);
+  glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  glState().bindVertexArray(VAO);
+  if (target == GL_ARRAY_BUFFER) {
+    glBindBuffer(GL_ARRAY_BUFFER, grown);
+    vertexFormat.apply();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  } else {
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, grown);
+  }
+  glState().bindVertexArray(0);
+  glDeleteBuffers(1, &buffer);
+  buffer = grown;
+}
+// ------------------------------------------------------------------------
+IndirectRenderer::MeshHandle IndirectRenderer::appendMesh(const void* vertices,
+                                                          std::size_t vertexCount,
+                                                          const void* indices,
+                                                          std::size_t indexCount,
+                                                          GLenum indexType) {
+  // one index type for everything, so 16-bit meshes are widened on the way in
+  std::vector<std::uint32_t> wide;
+  if (indexType == GL_UNSIGNED_SHORT) {
+    const std::uint16_t* narrow = (const std::uint16_t*)indices;
+    wide.assign(narrow, narrow + indexCount);
+    indices = wide.data();
+  }
+  std::size_t newVertexBytes = vertexCount * vertexFormat.stride();
+  std::size_t newIndexBytes = indexCount * sizeof(std::uint32_t);
+  growBuffer(GL_ARRAY_BUFFER, VBO, vertexBytes, vertexCapacity, newVertexBytes);
+  growBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO, indexBytes, indexCapacity, newIndexBytes);
+
+  glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, vertexBytes, newVertexBytes, vertices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, indexBytes, newIndexBytes, indices);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  // indices stay relative to their own mesh; the base vertex moves them to its vertices
+  MeshRange range = {(std::uint32_t)(indexBytes / sizeof(std::uint32_t)),
+                     (std::uint32_t)indexCount,
+                     (std::int32_t)(vertexBytes / vertexFormat.stride())};
+  meshes.push_back(range);
+  vertexBytes += newVertexBytes;
+  indexBytes += newIndexBytes;
+  return (MeshHandle)meshes.size() - 1;
+}
+// ------------------------------------------------------------------------
+IndirectRenderer::MeshHandle IndirectRenderer::addMesh(const MeshBuilder& builder) {
+  if (builder.floatsPerVertex() != vertexFormat.floatsPerVertex() ||
+      builder.indexCount() == 0) {
+    std::cout << "ERROR::INDIRECT_RENDERER::FORMAT_MISMATCH" << std::endl;
+    return -1;
+  }
+  std::vector<unsigned char> packed =
+      vertexFormat.pack(builder.vertices().data(), builder.vertexCount());
+  return appendMesh(packed.data(), builder.vertexCount(), builder.indices().data(),
+                    builder.indexCount(), GL_UNSIGNED_INT);
+}
+// ------------------------------------------------------------------------
+IndirectRenderer::MeshHandle IndirectRenderer::addMesh(const MeshFile& file) {
+  const std::vector<VertexFormat::Attribute>& expected = vertexFormat.attributes();
+  bool matches = file.valid() && file.vertexStride() == vertexFormat.stride() &&
+                 file.attributes().size() == expected.size();
+  for (std::size_t i = 0; matches && i < expected.size(); i++) {
+    const MeshFileAttribute& attribute = file.attributes()[i];
+    matches = attribute.location == i && attribute.offset == expected[i].offset &&
+              (GLint)attribute.components == vertexFormat.glComponents(i) &&
+              attribute.glType == vertexFormat.glType(i) &&
+              (attribute.normalized != 0) == (vertexFormat.glNormalized(i) == GL_TRUE);
+  }
+  if (!matches) {
+    std::cout << "ERROR::INDIRECT_RENDERER::FORMAT_MISMATCH" << std::endl;
+    return -1;
+  }
+  return appendMesh(file.vertexData(), file.vertexCount(), file.indexData(), file.indexCount(),
+                    (GLenum)file.indexType());
+}
+// ------------------------------------------------------------------------
+std::size_t IndirectRenderer::meshCount() const { return meshes.size(); }
+// ------------------------------------------------------------------------
+void IndirectRenderer::begin() { objects.clear(); }
+// ------------------------------------------------------------------------
+void IndirectRenderer::draw(MeshHandle mesh, const glm::mat4& model) {
+  if (mesh < 0 || (std::size_t)mesh >= meshes.size()) return;
+  objects.push_back({mesh, model});
+}
+// ------------------------------------------------------------------------
+void IndirectRenderer::submit(GLenum mode) {
+  commands.clear();
+  draws = 0;
+  if (objects.empty()) return;
+
+  // a counting sort by mesh: each mesh's objects become one command's instances, in the
+  // order they were drawn
+  meshInstances.assign(meshes.size(), 0);
+  for (const Object& object : objects) meshInstances[object.mesh]++;
+  std::uint32_t first = 0;
+  for (std::size_t mesh = 0; mesh < meshes.size(); mesh++) {
+    std::uint32_t count = meshInstances[mesh];
+    meshInstances[mesh] = first;
+    if (count == 0) continue;
+    const MeshRange& range = meshes[mesh];
+    commands.push_back({range.indexCount, count, range.firstIndex, range.baseVertex, first});
+    first += count;
+  }
+  instances.resize(objects.size());
+  for (const Object& object : objects) instances[meshInstances[object.mesh]++] = object.model;
+
+  std::size_t instanceBytes = instances.size() * INSTANCE_BYTES;
+  std::size_t commandBytes = multiDraw ? commands.size() * sizeof(DrawElementsIndirectCommand) : 0;
+  // the command allocation's alignment can cost up to a command's worth
+  std::size_t bytes = instanceBytes + commandBytes + sizeof(DrawElementsIndirectCommand);
+  if (bytes > frameStream->frameSize()) attachStream(std::max(bytes, 2 * frameStream->frameSize()));
+
+  frameStream->beginFrame();
+  StreamAllocation instanceData = frameStream->allocate(instanceBytes, INSTANCE_BYTES);
+  StreamAllocation commandData = {nullptr, 0, 0};
+  if (multiDraw && instanceData.data) {
+    commandData = frameStream->allocate(commandBytes, sizeof(GLuint));
+  }
+  // the region was sized for both above, so this only guards against a bad size; the frame
+  // still has to end, or the stream would stay mapped into the next one
+  if (!instanceData.data || (multiDraw && !commandData.data)) {
+    frameStream->endFrame();
+    return;
+  }
+  std::memcpy(instanceData.data, instances.data(), instanceBytes);
+  // the instance array starts at the stream's beginning; this frame's matrices start here
+  GLuint instanceBase = (GLuint)(instanceData.offset / INSTANCE_BYTES);
+
+  glState().bindVertexArray(VAO);
+  if (multiDraw) {
+    DrawElementsIndirectCommand* out = (DrawElementsIndirectCommand*)commandData.data;
+    for (std::size_t i = 0; i < commands.size(); i++) {
+      out[i] = commands[i];
+      out[i].baseInstance += instanceBase;
+    }
+    frameStream->flush();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, frameStream->ID);
+    glExtensions().multiDrawElementsIndirect(mode, GL_UNSIGNED_INT, (void*)commandData.offset,
+                                             (GLsizei)commands.size(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    draws = 1;
+  } else {
+    frameStream->flush();
+    // no baseInstance before GL 4.2, so each command gets the instance array re-pointed at
+    // its own matrices instead
+    for (const DrawElementsIndirectCommand& command : commands) {
+      pointInstances((instanceBase + command.baseInstance) * INSTANCE_BYTES);
+      glDrawElementsInstancedBaseVertex(
+          mode, (GLsizei)command.count, GL_UNSIGNED_INT,
+          (void*)(command.firstIndex * sizeof(std::uint32_t)), (GLsizei)command.instanceCount,
+          command.baseVertex);
+    }
+    draws = commands.size();
+  }
+  frameStream->endFrame();
+}
+// ------------------------------------------------------------------------
+bool IndirectRenderer::indirect() const { return multiDraw; }
+
+std::size_t IndirectRenderer::objectCount() const { return objects.size(); }
+
+std::size_t IndirectRenderer::commandCount() const { return commands.size(); }
+
+std::size_t IndirectRenderer::drawCalls() const { return draws; }
+
+const StreamBuffer& IndirectRenderer::stream() const { return *frameStream; }
+// ------------------------------------------------------------------------
+void IndirectRenderer::release() {
+  if (VAO) glState().forgetVertexArray(VAO);
+  glDeleteVertexArrays(1, &VAO);
+  glDeleteBuffers(1, &VBO);
+  glDeleteBuffers(1, &EBO);
+  VAO = VBO = EBO = 0;
+  if (frameStream) frameStream->release();
+}
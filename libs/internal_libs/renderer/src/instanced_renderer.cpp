@@ -0,0 +1,128 @@
+#include "instanced_renderer.h"
+#include <gl_state.h>
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const std::size_t INSTANCE_BYTES = sizeof(glm::mat4);
+// the ring's first size; it doubles whenever a set doesn't fit
+const std::size_t INITIAL_INSTANCES = 256;
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+InstancedRenderer::InstancedRenderer(unsigned int vao, unsigned int firstLocation)
+    : vao(vao), location(firstLocation) {
+  instanceStream.reset(new StreamBuffer(INITIAL_INSTANCES * INSTANCE_BYTES));
+  glState().bindVertexArray(vao);
+  // a mat4 attribute takes four locations, one per column
+  pointInstances(0);
+  for (unsigned int column = 0; column < 4; column++) {
+    glEnableVertexAttribArray(location + column);
+    // advance once per instance instead of once per vertex
+    glVertexAttribDivisor(location + column, 1);
+  }
+  glState().bindVertexArray(0);
+}
+// ------------------------------------------------------------------------
+void InstancedRenderer::setInstances(const glm::mat4* transforms, std::size_t count) {
+  instances.assign(transforms, transforms + count);
+  upload();
+}
+// ------------------------------------------------------------------------
+void InstancedRenderer::updateInstances(std::size_t first, const glm::mat4* transforms,
+                                        std::size_t count) {
+  if (first >= instances.size()) return;
+  if (count > instances.size() - first) count = instances.size() - first;
+  std::copy(transforms, transforms + count, instances.begin() + first);
+  upload();
+}
+// a fresh copy of every instance in the ring's next region; the copies before it stay put
+// until draws already issued have read them
+// ------------------------------------------------------------------------
+void InstancedRenderer::upload() {
+  if (instances.empty()) return;
+  std::size_t bytes = instances.size() * INSTANCE_BYTES;
+  if (bytes > instanceStream->frameSize()) {
+    std::size_t frameSize = std::max(bytes, 2 * instanceStream->frameSize());
+    instanceStream->release();
+    instanceStream.reset(new StreamBuffer(frameSize));
+  }
+  instanceStream->beginFrame();
+  StreamAllocation data = instanceStream->allocate(bytes, INSTANCE_BYTES);
+  if (data.data) std::memcpy(data.data, instances.data(), bytes);
+  instanceStream->flush();
+  if (data.data) {
+    glState().bindVertexArray(vao);
+    pointInstances(data.offset);
+    glState().bindVertexArray(0);
+  }
+  instanceStream->endFrame();
+}
+// the VAO must be bound
+// ------------------------------------------------------------------------
+void InstancedRenderer::pointInstances(std::size_t offset) {
+  glBindBuffer(GL_ARRAY_BUFFER, instanceStream->ID);
+  for (unsigned int column = 0; column < 4; column++) {
+    glVertexAttribPointer(location + column, 4, GL_FLOAT, GL_FALSE, INSTANCE_BYTES,
+                          (void*)(offset + column * sizeof(glm::vec4)));
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// ------------------------------------------------------------------------
+std::size_t InstancedRenderer::instanceCount() const { return instances.size(); }
+// ------------------------------------------------------------------------
+void InstancedRenderer::draw(GLenum mode, int firstVertex, int vertexCount) const {
+  if (instances.empty()) return;
+  glState().bindVertexArray(vao);
+  glDrawArraysInstanced(mode, firstVertex, vertexCount, (GLsizei)instances.size());
+}
+// ------------------------------------------------------------------------
+void InstancedRenderer::drawElements(GLenum mode, int indexCount, GLenum indexType) const {
+  if (instances.empty()) return;
+  glState().bindVertexArray(vao);
+  glDrawElementsInstanced(mode, indexCount, indexType, 0, (GLsizei)instances.size());
+}
+// ------------------------------------------------------------------------
+void InstancedRenderer::drawUnbatched(GLenum mode, int firstVertex, int vertexCount) const {
+  glState().bindVertexArray(vao);
+  // with the arrays disabled the attribute reads the current generic value instead
+  setInstanceArraysEnabled(false);
+  for (const glm::mat4& model : instances) {
+    for (unsigned int column = 0; column < 4; column++) {
+      glVertexAttrib4fv(location + column, &model[column][0]);
+    }
+    glDrawArrays(mode, firstVertex, vertexCount);
+  }
+  setInstanceArraysEnabled(true);
+}
+// ------------------------------------------------------------------------
+void InstancedRenderer::drawElementsUnbatched(GLenum mode, int indexCount,
+                                              GLenum indexType) const {
+  glState().bindVertexArray(vao);
+  setInstanceArraysEnabled(false);
+  for (const glm::mat4& model : instances) {
+    for (unsigned int column = 0; column < 4; column++) {
+      glVertexAttrib4fv(location + column, &model[column][0]);
+    }
+    glDrawElements(mode, indexCount, indexType, 0);
+  }
+  setInstanceArraysEnabled(true);
+}
+// ------------------------------------------------------------------------
+const StreamBuffer& InstancedRenderer::stream() const { return *instanceStream; }
+
+void InstancedRenderer::release() { instanceStream->release(); }
+// ------------------------------------------------------------------------
+void InstancedRenderer::setInstanceArraysEnabled(bool enabled) const {
+  for (unsigned int column = 0; column < 4; column++) {
+    if (enabled) {
+      glEnableVertexAttribArray(location + column);
+    } else {
+      glDisableVertexAttribArray(location + column);
+    }
+  }
+}
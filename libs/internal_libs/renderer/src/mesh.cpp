@@ -0,0 +1,191 @@
+#include "mesh.h"
+#include <fnv1a.h>
+#include <gl_state.h>
+
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+const std::uint32_t EMPTY_SLOT = 0xffffffffu;
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+Mesh::Mesh()
+    : VAO(0), VBO(0), EBO(0), vertices(0), bytes(0), indices(0), type(GL_UNSIGNED_SHORT) {}
+// ------------------------------------------------------------------------
+Mesh Mesh::fromFile(const MeshFile& file, GLenum usage) {
+  Mesh mesh;
+  if (!file.valid()) {
+    std::cout << "ERROR::MESH::INVALID_FILE" << std::endl;
+    return mesh;
+  }
+  mesh.vertices = file.vertexCount();
+  mesh.bytes = file.vertexDataSize();
+  mesh.indices = file.indexCount();
+  mesh.type = (GLenum)file.indexType();
+  glGenVertexArrays(1, &mesh.VAO);
+  glGenBuffers(1, &mesh.VBO);
+  glGenBuffers(1, &mesh.EBO);
+
+  glState().bindVertexArray(mesh.VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+  glBufferData(GL_ARRAY_BUFFER, file.vertexDataSize(), file.vertexData(), usage);
+  for (const MeshFileAttribute& attribute : file.attributes()) {
+    glVertexAttribPointer(attribute.location, (GLint)attribute.components, attribute.glType,
+                          attribute.normalized ? GL_TRUE : GL_FALSE,
+                          (GLsizei)file.vertexStride(), (void*)(std::size_t)attribute.offset);
+    glEnableVertexAttribArray(attribute.location);
+  }
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, file.indexDataSize(), file.indexData(), usage);
+  glState().bindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return mesh;
+}
+// ------------------------------------------------------------------------
+std::size_t Mesh::vertexCount() const { return vertices; }
+
+std::size_t Mesh::vertexBytes() const { return bytes; }
+
+std::size_t Mesh::indexCount() const { return indices; }
+
+GLenum Mesh::indexType() const { return type; }
+// ------------------------------------------------------------------------
+void Mesh::draw(GLenum mode) const {
+  if (indices == 0) return;
+  glState().bindVertexArray(VAO);
+  glDrawElements(mode, (GLsizei)indices, type, 0);
+}
+// ------------------------------------------------------------------------
+void Mesh::release() {
+  if (VAO) glState().forgetVertexArray(VAO);
+  glDeleteVertexArrays(1, &VAO);
+  glDeleteBuffers(1, &VBO);
+  glDeleteBuffers(1, &EBO);
+  VAO = VBO = EBO = 0;
+  vertices = bytes = indices = 0;
+}
+
+// ------------------------------------------------------------------------
+MeshBuilder::MeshBuilder(const std::vector<int>& attributeSizes)
+    : attributes(attributeSizes), stride(0) {
+  for (int size : attributes) stride += size;
+}
+// ------------------------------------------------------------------------
+int MeshBuilder::floatsPerVertex() const { return stride; }
+
+std::size_t MeshBuilder::vertexCount() const { return stride ? vertexData.size() / stride : 0; }
+
+std::size_t MeshBuilder::vertexBytes() const { return vertexData.size() * sizeof(float); }
+
+std::size_t MeshBuilder::indexCount() const { return indexData.size(); }
+
+const std::vector<float>& MeshBuilder::vertices() const { return vertexData; }
+
+const std::vector<std::uint32_t>& MeshBuilder::indices() const { return indexData; }
+// ------------------------------------------------------------------------
+std::uint32_t MeshBuilder::hashVertex(const float* vertex) const {
+  return fnv1a32Bytes(vertex, stride * sizeof(float));
+}
+// ------------------------------------------------------------------------
+void MeshBuilder::rehash(std::size_t slotCount) {
+  slots.assign(slotCount, EMPTY_SLOT);
+  std::size_t mask = slotCount - 1;
+  std::size_t count = vertexCount();
+  for (std::size_t i = 0; i < count; i++) {
+    std::size_t slot = hashVertex(&vertexData[i * stride]) & mask;
+    while (slots[slot] != EMPTY_SLOT) slot = (slot + 1) & mask;
+    slots[slot] = (std::uint32_t)i;
+  }
+}
+// ------------------------------------------------------------------------
+std::uint32_t MeshBuilder::addVertex(const float* vertex) {
+  // -0 and 0 compare equal but hash differently, so fold them before either
+  key.assign(vertex, vertex + stride);
+  for (float& component : key) {
+    if (component == 0.0f) component = 0.0f;
+  }
+  // stay under half full so probe runs stay short
+  std::size_t count = vertexCount();
+  if ((count + 1) * 2 > slots.size()) rehash(slots.empty() ? 64 : slots.size() * 2);
+
+  std::size_t mask = slots.size() - 1;
+  std::size_t slot = hashVertex(key.data()) & mask;
+  while (slots[slot] != EMPTY_SLOT) {
+    std::uint32_t existing = slots[slot];
+    if (std::memcmp(&vertexData[existing * stride], key.data(), stride * sizeof(float)) == 0) {
+      return existing;
+    }
+    slot = (slot + 1) & mask;
+  }
+  slots[slot] = (std::uint32_t)count;
+  vertexData.insert(vertexData.end(), key.begin(), key.end());
+  return (std::uint32_t)count;
+}
+// ------------------------------------------------------------------------
+void MeshBuilder::addTriangles(const float* vertices, std::size_t count) {
+  indexData.reserve(indexData.size() + count);
+  for (std::size_t i = 0; i < count; i++) indexData.push_back(addVertex(vertices + i * stride));
+}
+// ------------------------------------------------------------------------
+void MeshBuilder::addTriangle(std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+  indexData.push_back(a);
+  indexData.push_back(b);
+  indexData.push_back(c);
+}
+// ------------------------------------------------------------------------
+void MeshBuilder::clear() {
+  vertexData.clear();
+  indexData.clear();
+  slots.clear();
+}
+// ------------------------------------------------------------------------
+Mesh MeshBuilder::build(GLenum usage) const {
+  return build(VertexFormat::floats(attributes), usage);
+}
+// ------------------------------------------------------------------------
+Mesh MeshBuilder::build(const VertexFormat& format, GLenum usage) const {
+  Mesh mesh;
+  if (stride == 0 || indexData.empty()) {
+    std::cout << "ERROR::MESH::EMPTY" << std::endl;
+    return mesh;
+  }
+  bool matches = format.attributes().size() == attributes.size();
+  for (std::size_t i = 0; matches && i < attributes.size(); i++) {
+    matches = format.attributes()[i].components == attributes[i];
+  }
+  if (!matches) {
+    std::cout << "ERROR::MESH::FORMAT_MISMATCH" << std::endl;
+    return mesh;
+  }
+  mesh.vertices = vertexCount();
+  mesh.indices = indexData.size();
+  std::vector<unsigned char> packed = format.pack(vertexData.data(), mesh.vertices);
+  mesh.bytes = packed.size();
+  glGenVertexArrays(1, &mesh.VAO);
+  glGenBuffers(1, &mesh.VBO);
+  glGenBuffers(1, &mesh.EBO);
+
+  glState().bindVertexArray(mesh.VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+  glBufferData(GL_ARRAY_BUFFER, packed.size(), packed.data(), usage);
+  format.apply();
+
+  // the element binding is VAO state, so it stays bound when the VAO is unbound
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+  if (mesh.vertices <= 0xffff) {
+    std::vector<std::uint16_t> shortIndices(indexData.begin(), indexData.end());
+    mesh.type = GL_UNSIGNED_SHORT;
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(std::uint16_t),
+                 shortIndices.data(), usage);
+  } else {
+    mesh.type = GL_UNSIGNED_INT;
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexData.size() * sizeof(std::uint32_t),
+                 indexData.data(), usage);
+  }
+  glState().bindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  return mesh;
+}
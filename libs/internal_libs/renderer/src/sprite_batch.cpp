@@ -0,0 +1,145 @@
+#include "sprite_batch.h"
+#include <gl_state.h>
+
+#include <algorithm>
+
+// ------------------------------------------------------------------------
+SpriteBatch::SpriteBatch(std::size_t quadsPerDraw)
+    : VAO(0),
+      EBO(0),
+      quadsPerDraw(std::min<std::size_t>(std::max<std::size_t>(quadsPerDraw, 1), 16384)),
+      usedBuckets(0),
+      lastBucket(0),
+      quads(0),
+      draws(0) {
+  // every draw uses quads 0..n of the same pattern; glDrawElementsBaseVertex moves it along
+  std::vector<std::uint16_t> indices(this->quadsPerDraw * 6);
+  for (std::size_t i = 0; i < this->quadsPerDraw; i++) {
+    std::uint16_t first = (std::uint16_t)(i * 4);
+    std::uint16_t quad[6] = {first, (std::uint16_t)(first + 1), (std::uint16_t)(first + 2),
+                             first, (std::uint16_t)(first + 2), (std::uint16_t)(first + 3)};
+    std::copy(quad, quad + 6, indices.begin() + i * 6);
+  }
+  glGenVertexArrays(1, &VAO);
+  glGenBuffers(1, &EBO);
+  glState().bindVertexArray(VAO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint16_t), indices.data(),
+               GL_STATIC_DRAW);
+  glState().bindVertexArray(0);
+  attachStream(1024 * 4 * sizeof(Vertex));
+}
+// a new ring for the vertices, and the VAO pointed at it
+// ------------------------------------------------------------------------
+void SpriteBatch::attachStream(std::size_t frameSize) {
+  if (vertexStream) vertexStream->release();
+  vertexStream.reset(new StreamBuffer(frameSize));
+  glState().bindVertexArray(VAO);
+  glBindBuffer(GL_ARRAY_BUFFER, vertexStream->ID);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, x));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, u));
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+                        (void*)offsetof(Vertex, color));
+  glEnableVertexAttribArray(2);
+  glState().bindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+// ------------------------------------------------------------------------
+void SpriteBatch::begin() {
+  for (std::size_t i = 0; i < usedBuckets; i++) buckets[i].vertices.clear();
+  usedBuckets = 0;
+  lastBucket = 0;
+}
+// sprites tend to come in runs of the same texture, so the last bucket is checked first
+// ------------------------------------------------------------------------
+SpriteBatch::Bucket& SpriteBatch::bucketFor(GLenum target, unsigned int texture) {
+  if (lastBucket < usedBuckets && buckets[lastBucket].texture == texture &&
+      buckets[lastBucket].target == target) {
+    return buckets[lastBucket];
+  }
+  for (std::size_t i = 0; i < usedBuckets; i++) {
+    if (buckets[i].texture == texture && buckets[i].target == target) {
+      lastBucket = i;
+      return buckets[i];
+    }
+  }
+  if (usedBuckets == buckets.size()) buckets.emplace_back();
+  lastBucket = usedBuckets++;
+  buckets[lastBucket].target = target;
+  buckets[lastBucket].texture = texture;
+  return buckets[lastBucket];
+}
+// ------------------------------------------------------------------------
+void SpriteBatch::draw(GLenum target, unsigned int texture, const glm::vec2& center,
+                       const glm::vec2& size, const TextureRegion& region,
+                       const glm::vec4& color) {
+  Bucket& bucket = bucketFor(target, texture);
+  glm::vec4 clamped = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+  std::uint8_t rgba[4] = {(std::uint8_t)clamped.r, (std::uint8_t)clamped.g,
+                          (std::uint8_t)clamped.b, (std::uint8_t)clamped.a};
+  glm::vec2 half = size * 0.5f;
+  float layer = (float)region.layer;
+  // counter-clockwise from the bottom left, matching the index pattern
+  Vertex corners[4] = {
+      {center.x - half.x, center.y - half.y, region.u0, region.v0, layer, {}},
+      {center.x + half.x, center.y - half.y, region.u1, region.v0, layer, {}},
+      {center.x + half.x, center.y + half.y, region.u1, region.v1, layer, {}},
+      {center.x - half.x, center.y + half.y, region.u0, region.v1, layer, {}},
+  };
+  for (Vertex& corner : corners) std::copy(rgba, rgba + 4, corner.color);
+  bucket.vertices.insert(bucket.vertices.end(), corners, corners + 4);
+}
+// ------------------------------------------------------------------------
+void SpriteBatch::end() {
+  quads = 0;
+  draws = 0;
+  for (std::size_t i = 0; i < usedBuckets; i++) quads += buckets[i].vertices.size() / 4;
+  if (quads == 0) return;
+
+  std::size_t bytes = quads * 4 * sizeof(Vertex);
+  if (bytes > vertexStream->frameSize()) {
+    attachStream(std::max(bytes, 2 * vertexStream->frameSize()));
+  }
+  vertexStream->beginFrame();
+  StreamAllocation allocation = vertexStream->allocate(bytes, sizeof(Vertex));
+  if (!allocation.data) return;
+  Vertex* out = (Vertex*)allocation.data;
+  for (std::size_t i = 0; i < usedBuckets; i++) {
+    const std::vector<Vertex>& vertices = buckets[i].vertices;
+    std::copy(vertices.begin(), vertices.end(), out);
+    out += vertices.size();
+  }
+  vertexStream->flush();
+
+  glState().bindVertexArray(VAO);
+  // the VAO's pointers start at the buffer's beginning; the base vertex skips to this frame
+  GLint baseVertex = (GLint)(allocation.offset / sizeof(Vertex));
+  for (std::size_t i = 0; i < usedBuckets; i++) {
+    const Bucket& bucket = buckets[i];
+    glState().bindTexture(bucket.target, bucket.texture);
+    std::size_t bucketQuads = bucket.vertices.size() / 4;
+    for (std::size_t first = 0; first < bucketQuads; first += quadsPerDraw) {
+      std::size_t count = std::min(quadsPerDraw, bucketQuads - first);
+      glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)(count * 6), GL_UNSIGNED_SHORT, nullptr,
+                               baseVertex + (GLint)(first * 4));
+      draws++;
+    }
+    baseVertex += (GLint)bucket.vertices.size();
+  }
+  vertexStream->endFrame();
+}
+// ------------------------------------------------------------------------
+std::size_t SpriteBatch::quadCount() const { return quads; }
+
+std::size_t SpriteBatch::drawCalls() const { return draws; }
+
+const StreamBuffer& SpriteBatch::stream() const { return *vertexStream; }
+// ------------------------------------------------------------------------
+void SpriteBatch::release() {
+  glState().forgetVertexArray(VAO);
+  glDeleteVertexArrays(1, &VAO);
+  glDeleteBuffers(1, &EBO);
+  vertexStream->release();
+}
@@ -0,0 +1,193 @@
+#include "vertex_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+std::size_t componentBytes(VertexAttributeType type) {
+  switch (type) {
+    case VertexAttributeType::Float:
+      return 4;
+    case VertexAttributeType::HalfFloat:
+    case VertexAttributeType::Snorm16:
+    case VertexAttributeType::Unorm16:
+      return 2;
+    case VertexAttributeType::Snorm8:
+    case VertexAttributeType::Unorm8:
+      return 1;
+    default:
+      return 0;  // packed: the whole attribute is one word
+  }
+}
+
+std::size_t attributeBytes(VertexAttributeType type, int components) {
+  if (type == VertexAttributeType::Snorm10_10_10_2) return 4;
+  return componentBytes(type) * components;
+}
+
+GLenum attributeGLType(VertexAttributeType type) {
+  switch (type) {
+    case VertexAttributeType::Float:
+      return GL_FLOAT;
+    case VertexAttributeType::HalfFloat:
+      return GL_HALF_FLOAT;
+    case VertexAttributeType::Snorm16:
+      return GL_SHORT;
+    case VertexAttributeType::Unorm16:
+      return GL_UNSIGNED_SHORT;
+    case VertexAttributeType::Snorm8:
+      return GL_BYTE;
+    case VertexAttributeType::Unorm8:
+      return GL_UNSIGNED_BYTE;
+    default:
+      return GL_INT_2_10_10_10_REV;
+  }
+}
+
+// GL 4.2's signed normalization: -max and max map to -1 and 1, the one extra negative is
+// never produced
+long snorm(float value, int bits) {
+  long max = (1L << (bits - 1)) - 1;
+  return std::lround(std::min(std::max(value, -1.0f), 1.0f) * (float)max);
+}
+
+unsigned long unorm(float value, int bits) {
+  unsigned long max = (1UL << bits) - 1;
+  return (unsigned long)std::lround(std::min(std::max(value, 0.0f), 1.0f) * (float)max);
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+std::uint16_t floatToHalf(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  std::uint16_t sign = (std::uint16_t)((bits >> 16) & 0x8000);
+  bits &= 0x7fffffff;
+  if (bits >= (143u << 23)) {
+    // too big for a half even before rounding (or NaN, which stays NaN)
+    return sign | (bits > (255u << 23) ? 0x7e00 : 0x7c00);
+  }
+  if (bits < (113u << 23)) {
+    // a half subnormal: adding 0.5 lines the mantissa up so the FPU does the rounding
+    float shifted;
+    std::memcpy(&shifted, &bits, sizeof(shifted));
+    shifted += 0.5f;
+    std::uint32_t rounded;
+    std::memcpy(&rounded, &shifted, sizeof(rounded));
+    return sign | (std::uint16_t)(rounded - (126u << 23));
+  }
+  // rebias the exponent and round the 13 dropped bits to nearest, ties to even; a carry out
+  // of the mantissa bumps the exponent, up to infinity
+  std::uint32_t odd = (bits >> 13) & 1;
+  bits -= (127u - 15u) << 23;
+  bits += 0xfff + odd;
+  return sign | (std::uint16_t)(bits >> 13);
+}
+// ------------------------------------------------------------------------
+VertexFormat::VertexFormat() : vertexStride(0), floatCount(0) {}
+// ------------------------------------------------------------------------
+VertexFormat VertexFormat::floats(const std::vector<int>& componentCounts) {
+  VertexFormat format;
+  for (int components : componentCounts) format.add(VertexAttributeType::Float, components);
+  return format;
+}
+// ------------------------------------------------------------------------
+VertexFormat& VertexFormat::add(VertexAttributeType type, int components) {
+  components = std::min(std::max(components, 1), 4);
+  attributeList.push_back({type, components, vertexStride});
+  vertexStride += (attributeBytes(type, components) + 3) & ~(std::size_t)3;
+  floatCount += components;
+  return *this;
+}
+// ------------------------------------------------------------------------
+const std::vector<VertexFormat::Attribute>& VertexFormat::attributes() const {
+  return attributeList;
+}
+
+std::size_t VertexFormat::stride() const { return vertexStride; }
+
+int VertexFormat::floatsPerVertex() const { return floatCount; }
+
+std::size_t VertexFormat::bytesSaved(std::size_t vertexCount) const {
+  std::size_t floatBytes = floatCount * sizeof(float);
+  return floatBytes > vertexStride ? (floatBytes - vertexStride) * vertexCount : 0;
+}
+// ------------------------------------------------------------------------
+std::vector<unsigned char> VertexFormat::pack(const float* vertices,
+                                              std::size_t vertexCount) const {
+  std::vector<unsigned char> packed(vertexStride * vertexCount, 0);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    const float* in = vertices + v * floatCount;
+    unsigned char* vertex = packed.data() + v * vertexStride;
+    for (const Attribute& attribute : attributeList) {
+      unsigned char* out = vertex + attribute.offset;
+      if (attribute.type == VertexAttributeType::Snorm10_10_10_2) {
+        // x, y, z in the low 30 bits, w in the top two; components not given are 0
+        std::uint32_t word = 0;
+        for (int c = 0; c < attribute.components; c++) {
+          int bits = c < 3 ? 10 : 2;
+          word |= ((std::uint32_t)snorm(in[c], bits) & ((1u << bits) - 1)) << (c * 10);
+        }
+        std::memcpy(out, &word, sizeof(word));
+      } else {
+        for (int c = 0; c < attribute.components; c++) {
+          switch (attribute.type) {
+            case VertexAttributeType::Float:
+              std::memcpy(out + c * 4, &in[c], 4);
+              break;
+            case VertexAttributeType::HalfFloat: {
+              std::uint16_t half = floatToHalf(in[c]);
+              std::memcpy(out + c * 2, &half, 2);
+              break;
+            }
+            case VertexAttributeType::Snorm16: {
+              std::int16_t value = (std::int16_t)snorm(in[c], 16);
+              std::memcpy(out + c * 2, &value, 2);
+              break;
+            }
+            case VertexAttributeType::Unorm16: {
+              std::uint16_t value = (std::uint16_t)unorm(in[c], 16);
+              std::memcpy(out + c * 2, &value, 2);
+              break;
+            }
+            case VertexAttributeType::Snorm8:
+              out[c] = (unsigned char)(std::int8_t)snorm(in[c], 8);
+              break;
+            default:
+              out[c] = (unsigned char)unorm(in[c], 8);
+              break;
+          }
+        }
+      }
+      in += attribute.components;
+    }
+  }
+  return packed;
+}
+// ------------------------------------------------------------------------
+GLint VertexFormat::glComponents(std::size_t attribute) const {
+  // the packed type only comes in fours; the shader ignores what it doesn't declare
+  const Attribute& entry = attributeList[attribute];
+  return entry.type == VertexAttributeType::Snorm10_10_10_2 ? 4 : entry.components;
+}
+
+GLenum VertexFormat::glType(std::size_t attribute) const {
+  return attributeGLType(attributeList[attribute].type);
+}
+
+GLboolean VertexFormat::glNormalized(std::size_t attribute) const {
+  VertexAttributeType type = attributeList[attribute].type;
+  return type == VertexAttributeType::Float || type == VertexAttributeType::HalfFloat ? GL_FALSE
+                                                                                       : GL_TRUE;
+}
+// ------------------------------------------------------------------------
+void VertexFormat::apply(std::size_t baseOffset) const {
+  for (std::size_t i = 0; i < attributeList.size(); i++) {
+    glVertexAttribPointer((GLuint)i, glComponents(i), glType(i), glNormalized(i),
+                          (GLsizei)vertexStride, (void*)(baseOffset + attributeList[i].offset));
+    glEnableVertexAttribArray((GLuint)i);
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef FNV1A_H
+#define FNV1A_H
+
+#include <cstddef>
+#include <cstdint>
+
+// 32-bit FNV-1a. Written as a single-return recursion so it stays usable in constant
+// expressions, which is what lets uniform names be hashed at compile time.
+constexpr std::uint32_t fnv1a32(const char *str, std::uint32_t hash = 2166136261u) {
+  return *str ? fnv1a32(str + 1, (hash ^ (std::uint32_t)(unsigned char)*str) * 16777619u) : hash;
+}
+
+// runtime variant for buffers that aren't null terminated
+inline std::uint32_t fnv1a32Bytes(const void *data, std::size_t size,
+                                  std::uint32_t hash = 2166136261u) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (std::size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 16777619u;
+  return hash;
+}
+
+// 64-bit variant for content hashes (cache keys) where 32 bits would collide too easily
+inline std::uint64_t fnv1a64Bytes(const void *data, std::size_t size,
+                                  std::uint64_t hash = 14695981039346656037ull) {
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (std::size_t i = 0; i < size; i++) hash = (hash ^ bytes[i]) * 1099511628211ull;
+  return hash;
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+#include <glad/glad.h>
+
+// glad was generated for the GL 3.3 core set only. Anything newer that we can take
+// advantage of lives here: the enums we need, plus entry points resolved at runtime.
+// Every pointer is null unless its feature flag is set, so always check the flag first.
+
+// GL 4.1 / ARB_get_program_binary
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// KHR_parallel_shader_compile (ARB_parallel_shader_compile uses the same values)
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// GL 4.4 / ARB_buffer_storage
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DYNAMIC_STORAGE_BIT
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#endif
+#ifndef GL_CLIENT_STORAGE_BIT
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+// EXT_texture_compression_s3tc (BC1-BC3)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// GL 4.2 / ARB_texture_compression_bptc (BC7)
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+
+// GL 4.0 / ARB_draw_indirect
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+typedef void(APIENTRYP GLGetProgramBinaryFn)(GLuint program, GLsizei bufSize, GLsizei *length,
+                                             GLenum *binaryFormat, void *binary);
+typedef void(APIENTRYP GLProgramBinaryFn)(GLuint program, GLenum binaryFormat, const void *binary,
+                                          GLsizei length);
+typedef void(APIENTRYP GLProgramParameteriFn)(GLuint program, GLenum pname, GLint value);
+typedef void(APIENTRYP GLMaxShaderCompilerThreadsFn)(GLuint count);
+typedef void(APIENTRYP GLBufferStorageFn)(GLenum target, GLsizeiptr size, const void *data,
+                                          GLbitfield flags);
+typedef void(APIENTRYP GLMultiDrawElementsIndirectFn)(GLenum mode, GLenum type,
+                                                      const void *indirect, GLsizei drawcount,
+                                                      GLsizei stride);
+
+struct GLExtensions {
+  int majorVersion = 0;
+  int minorVersion = 0;
+
+  // glGetProgramBinary/glProgramBinary, and the driver offers at least one binary format
+  bool programBinary = false;
+  GLGetProgramBinaryFn getProgramBinary = nullptr;
+  GLProgramBinaryFn programBinaryLoad = nullptr;
+  GLProgramParameteriFn programParameteri = nullptr;
+
+  // compiles and links run on driver threads; GL_COMPLETION_STATUS_KHR can be polled
+  bool parallelShaderCompile = false;
+  GLMaxShaderCompilerThreadsFn maxShaderCompilerThreads = nullptr;
+
+  // immutable buffer storage, which can stay mapped (persistently) while the GPU reads it
+  bool bufferStorage = false;
+  GLBufferStorageFn bufferStorageData = nullptr;
+
+  // glMultiDrawElementsIndirect (GL 4.3 / ARB_multi_draw_indirect), which also means the
+  // commands' baseInstance is honoured
+  bool multiDrawIndirect = false;
+  GLMultiDrawElementsIndirectFn multiDrawElementsIndirect = nullptr;
+
+  // block-compressed texture formats glCompressedTexImage2D accepts
+  bool textureCompressionS3TC = false;
+  bool textureCompressionBPTC = false;
+
+  bool hasVersion(int major, int minor) const;
+  bool hasExtension(const char *name) const;
+};
+
+// queried from the current context on first use, so only call it after gladLoadGLLoader
+const GLExtensions &glExtensions();
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+// Which cached call a counter belongs to
+enum class GLStateCall { UseProgram, BindVertexArray, ActiveTexture, BindTexture, Capability, Count };
+
+struct GLStateCounters {
+  // calls passed on to the driver / skipped because the state was already set
+  unsigned long long issued[(int)GLStateCall::Count];
+  unsigned long long elided[(int)GLStateCall::Count];
+
+  unsigned long long totalIssued() const;
+  unsigned long long totalElided() const;
+};
+
+// Mirror of the bits of GL state the apps change every frame. Each setter is a drop-in for
+// the GL call of the same name and only reaches the driver when the value actually changes.
+// Everything starts out unknown, so the first call of each kind always goes through.
+//
+// The cache only knows about changes made through it. Code that calls GL directly in between
+// must call invalidate() afterwards (binding during setup, before the frame loop, is fine as
+// long as the loop itself goes through the cache).
+class GLState {
+ public:
+  GLState();
+
+  void useProgram(unsigned int program);
+  void bindVertexArray(unsigned int vao);
+  // unit is GL_TEXTURE0 + i, as for glActiveTexture
+  void activeTexture(GLenum unit);
+  // binds on the active unit; GL_TEXTURE_2D, _2D_ARRAY, _3D and _CUBE_MAP are cached
+  void bindTexture(GLenum target, unsigned int texture);
+  // GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST and GL_STENCIL_TEST are cached
+  void enable(GLenum capability);
+  void disable(GLenum capability);
+
+  // objects about to be deleted: GL may hand their names out again, so stop trusting them
+  void forgetProgram(unsigned int program);
+  void forgetVertexArray(unsigned int vao);
+  void forgetTexture(unsigned int texture);
+  // forget everything, e.g. after code that changed state behind the cache's back
+  void invalidate();
+
+  const GLStateCounters &counters() const;
+  void resetCounters();
+
+ private:
+  static const int TEXTURE_UNITS = 16;
+  static const int TEXTURE_TARGETS = 4;
+  static const int CAPABILITIES = 5;
+
+  unsigned int program;
+  unsigned int vertexArray;
+  int activeUnit;  // index, -1 if unknown
+  unsigned int textures[TEXTURE_UNITS][TEXTURE_TARGETS];
+  signed char capabilities[CAPABILITIES];  // -1 unknown, 0 disabled, 1 enabled
+  GLStateCounters stats;
+
+  void setCapability(GLenum capability, bool enabled);
+  bool changed(GLStateCall call, bool needed);
+};
+
+// the state cache for the current context; the apps only ever have one
+GLState &glState();
+#endif
@@ -0,0 +1,36 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. The bytes are paged in straight from the OS
+// file cache, so nothing is copied until somebody actually reads them.
+class MappedFile {
+ public:
+  MappedFile();
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  // false if the file couldn't be opened or mapped; an empty file is open with size 0
+  bool isOpen() const;
+  const unsigned char *data() const;
+  std::size_t size() const;
+
+ private:
+  const unsigned char *bytes;
+  std::size_t length;
+  bool open;
+#ifdef _WIN32
+  void *fileHandle;
+  void *mappingHandle;
+#endif
+
+  void close();
+};
+#endif
@@ -0,0 +1,52 @@
+#ifndef SHADER_BATCH_H
+#define SHADER_BATCH_H
+
+#include "shader_s.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Builds many Shader programs together. submit() issues every compile and link before asking
+// for a single status, so the driver can overlap the work (on its own threads when
+// GL_KHR_parallel_shader_compile is present), and poll() picks up finished programs without
+// stalling. Without the extension poll() still works, but each status query waits.
+class ShaderBatch {
+ public:
+  // queue a program for `shader`, which must outlive the batch; the sources are mapped here,
+  // nothing is sent to GL until submit()
+  void add(Shader &shader, const char *vertexPath, const char *fragmentPath);
+
+  // issue every queued compile and link
+  void submit();
+
+  // hand finished programs to their shaders; true once nothing is left in flight
+  bool poll();
+
+  // block until every submitted program is done
+  void finish();
+
+  // programs submitted but not yet handed over
+  std::size_t pending() const;
+
+ private:
+  enum class State { Queued, InFlight, Done };
+
+  struct Job {
+    Shader *shader = nullptr;
+    ShaderSource vertexSource;
+    ShaderSource fragmentSource;
+    std::uint64_t cacheKey = 0;
+    unsigned int vertex = 0;
+    unsigned int fragment = 0;
+    unsigned int program = 0;
+    bool fromBinary = false;
+    State state = State::Queued;
+  };
+  std::vector<Job> jobs;
+
+  void compile(Job &job);
+  void link(Job &job);
+  void complete(Job &job);
+};
+#endif
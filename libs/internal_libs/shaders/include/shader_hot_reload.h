@@ -0,0 +1,47 @@
+#ifndef SHADER_HOT_RELOAD_H
+#define SHADER_HOT_RELOAD_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Watches a vertex/fragment pair and rebuilds the program when either file changes.
+// File watching and reading happen on a background thread (inotify on Linux, timestamp
+// polling elsewhere); compiling happens in poll() on the GL thread and is spread over
+// frames, so the caller keeps rendering with its old program until the new one is ready.
+class ShaderHotReload {
+ public:
+  ShaderHotReload(const std::string &vertexPath, const std::string &fragmentPath);
+  ~ShaderHotReload();
+
+  ShaderHotReload(const ShaderHotReload &) = delete;
+  ShaderHotReload &operator=(const ShaderHotReload &) = delete;
+
+  // GL thread, once per frame: returns a freshly linked program when one is ready, else 0.
+  // Programs that fail to compile or link are reported and dropped.
+  unsigned int poll();
+
+ private:
+  std::string vertexPath;
+  std::string fragmentPath;
+
+  // written by the watcher thread, taken by poll()
+  std::mutex sourceMutex;
+  std::string pendingVertexCode;
+  std::string pendingFragmentCode;
+  bool sourcesPending;
+
+  std::atomic<bool> running;
+  std::thread watcher;
+
+  // GL objects of the rebuild currently in flight
+  unsigned int vertex;
+  unsigned int fragment;
+  unsigned int program;
+
+  void watch();
+  void readSources();
+  bool takeSources(std::string &vertexCode, std::string &fragmentCode);
+};
+#endif
@@ -8,25 +8,110 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+#include "shader_source.h"
+#include "uniform_id.h"
+
+class ShaderHotReload;
 
 class Shader {
  public:
   // the program ID
   unsigned int ID;
 
-  // constructor reads and builds the shader
+  // constructor reads and builds the shader, reusing a cached program binary when the
+  // driver offers program binaries and the sources haven't changed since the last run
   Shader(const char *vertexPath, const char *fragmentPath);
+  // same, from sources that are already in memory (or mapped)
+  Shader(const ShaderSource &vertexSource, const ShaderSource &fragmentSource);
+  // empty shader (ID 0) for ShaderBatch to fill in once its program finishes linking
+  Shader();
+  ~Shader();
+  Shader(Shader &&other) noexcept;
+  Shader &operator=(Shader &&other) noexcept;
+
+  // false until the program exists; only matters for shaders built through ShaderBatch
+  bool ready() const;
+
+  // where linked program binaries are kept between runs (<build>/cache/shaders unless set);
+  // an empty path disables the cache
+  static void setBinaryCacheDirectory(const std::string &directory);
 
-  // use/activate the shader
+  // use/activate the shader; skipped if it's already current (see gl_state.h)
   void use();
 
+  // opt-in hot reload: watch the files this shader was built from (or the given paths) and
+  // rebuild in the background. ID only changes inside pollHotReload, and only to a program
+  // that linked; raw locations from uniformLocation() are invalid after a swap.
+  void enableHotReload();
+  void enableHotReload(const char *vertexPath, const char *fragmentPath);
+  // call once per frame before use(); true if a reloaded program was swapped in
+  bool pollHotReload();
+
+  // cached location of an active uniform or any element of an active array ("weights[3]",
+  // "lights[2].color"), or -1 if the program doesn't have it
+  int uniformLocation(UniformId id) const;
+  int uniformLocation(const std::string &name) const;
+
+  // hashed-handle setters, e.g. set(UID("model"), model); no strings on the call path
+  void set(UniformId id, bool value) const;
+  void set(UniformId id, int value) const;
+  void set(UniformId id, float value) const;
+  void set(UniformId id, const glm::vec2 &value) const;
+  void set(UniformId id, const glm::vec3 &value) const;
+  void set(UniformId id, const glm::vec4 &value) const;
+  void set(UniformId id, const glm::mat4 &mat) const;
+
+  // per-frame data shared between programs goes through uniform blocks instead, see
+  // uniform_buffer.h; blocks are bound to their shared binding points when the program links
+
   // utility uniform functions
   void setBool(const std::string &name, bool value) const;
   void setInt(const std::string &name, int value) const;
   void setFloat(const std::string &name, float value) const;
+  void setVec2(const std::string &name, const glm::vec2 &value) const;
   void setMat4(const std::string &name, const glm::mat4 &mat) const;
 
+  void setBool(int location, bool value) const;
+  void setInt(int location, int value) const;
+  void setFloat(int location, float value) const;
+  void setVec2(int location, const glm::vec2 &value) const;
+  void setMat4(int location, const glm::mat4 &mat) const;
+
  private:
-  void checkCompileErrors(unsigned int shader, std::string type);
+  struct UniformSlot {
+    std::uint32_t hash;  // 0 marks an empty slot
+    int location;
+  };
+  // open-addressing table (linear probing, power-of-two size) of active uniforms keyed by
+  // name hash, built once after the program links
+  std::vector<UniformSlot> uniformSlots;
+
+  static std::string binaryCacheDirectory;
+
+  std::string vertexPath;
+  std::string fragmentPath;
+  std::unique_ptr<ShaderHotReload> hotReload;
+
+  friend class ShaderBatch;
+  friend class ShaderHotReload;
+
+  // building blocks shared by the constructor and ShaderBatch; none of them wait on the driver
+  static unsigned int compileShader(GLenum type, const ShaderSource &source);
+  static unsigned int linkProgram(unsigned int vertex, unsigned int fragment, bool retrievable);
+  static bool binaryCacheEnabled();
+  static std::uint64_t programCacheKey(const ShaderSource &vertexSource,
+                                       const ShaderSource &fragmentSource);
+  static unsigned int createProgramFromBinary(std::uint64_t key);
+  static void storeProgramBinary(unsigned int program, std::uint64_t key);
+  static bool checkCompileErrors(unsigned int shader, std::string type);
+
+  void cacheUniformLocations();
+  // uniform block bindings aren't part of a cached binary, so this runs after every link
+  void bindUniformBlocks();
+  void insertUniform(const char *name, int location);
 };
-#endif
\ No newline at end of file
+#endif
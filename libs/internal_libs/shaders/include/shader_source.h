@@ -0,0 +1,31 @@
+#ifndef SHADER_SOURCE_H
+#define SHADER_SOURCE_H
+
+#include "mapped_file.h"
+
+#include <cstddef>
+
+// GLSL source handed to glShaderSource as pointer + length, without copying it anywhere.
+// Files are memory mapped; in-memory sources (raw string literals, embedded assets) are
+// referenced as-is and must outlive the ShaderSource.
+class ShaderSource {
+ public:
+  ShaderSource();
+
+  static ShaderSource fromFile(const char *path);
+  // null-terminated source
+  static ShaderSource fromMemory(const char *code);
+  static ShaderSource fromMemory(const void *code, std::size_t size);
+
+  // false if the file couldn't be read
+  bool valid() const;
+  const char *data() const;
+  std::size_t size() const;
+
+ private:
+  MappedFile file;
+  const char *code;
+  std::size_t length;
+  bool ok;
+};
+#endif
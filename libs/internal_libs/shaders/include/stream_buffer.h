@@ -0,0 +1,74 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+
+// one sub-allocation: write `data`, then source the GL call from `offset` in the buffer
+struct StreamAllocation {
+  void *data;
+  std::size_t offset;
+  std::size_t size;
+};
+
+// A ring of `frames` regions in one buffer for data that is rewritten every frame: vertices,
+// instance attributes, uniform blocks. Each frame fills the next region through
+// sub-allocations and fences it when it's done; by the time the ring wraps round, the GPU has
+// normally long finished reading the region, so nothing is reallocated and the driver never
+// has to sync implicitly. If it hasn't, beginFrame() waits on the fence (and counts a stall).
+//
+// With buffer storage (GL 4.4 / ARB_buffer_storage) the buffer stays persistently and
+// coherently mapped. Otherwise each frame maps what it writes with glMapBufferRange
+// (unsynchronized, invalidating only that range, explicit flush) and flush() unmaps it again
+// before anything draws from it.
+//
+//   stream.beginFrame();
+//   StreamAllocation vertices = stream.allocate(bytes, sizeof(Vertex));
+//   memcpy(vertices.data, ...);
+//   stream.flush();
+//   glDrawArrays(..., vertices.offset / sizeof(Vertex), ...);
+//   stream.endFrame();
+class StreamBuffer {
+ public:
+  unsigned int ID;
+
+  // GL thread; `frameSize` bytes for each of `frames` regions
+  StreamBuffer(std::size_t frameSize, unsigned int frames = 3);
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+  bool persistent() const;
+  std::size_t frameSize() const;
+  // times beginFrame() had to wait for the GPU
+  unsigned long stalls() const;
+
+  // moves to the next region, waiting for the GPU to be done with it if it must
+  void beginFrame();
+  // `bytes` of this frame's region at an offset that is a multiple of `alignment` (e.g. the
+  // vertex size, or GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT for glBindBufferRange); data is
+  // nullptr once the region is full
+  StreamAllocation allocate(std::size_t bytes, std::size_t alignment = 16);
+  // makes what was written visible to GL; call before drawing from it (no-op if persistent)
+  void flush();
+  // fences the region; its memory is handed out again `frames` frames from now
+  void endFrame();
+
+  // GL thread: deletes the buffer and fences
+  void release();
+
+ private:
+  std::size_t regionSize;
+  unsigned int regionCount;
+  bool persistentMapping;
+  unsigned char *persistentBase;
+  // the region in use and how much of it is handed out
+  unsigned int region;
+  std::size_t cursor;
+  // explicit mapping: the mapped range of the region, from mapStart to the region's end
+  unsigned char *mapped;
+  std::size_t mapStart;
+  GLsync fences[8];
+  unsigned long stallCount;
+};
+#endif
@@ -0,0 +1,137 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "stream_buffer.h"
+
+#include <cstddef>
+
+// std140 rules for the types the apps put in uniform blocks. Offsets are in bytes; arrays
+// and matrices use a 16 byte stride per element/column regardless of the element type.
+namespace std140 {
+
+template <typename T>
+struct Rules;
+template <>
+struct Rules<float> {
+  static constexpr std::size_t align = 4, size = 4;
+};
+template <>
+struct Rules<int> {
+  static constexpr std::size_t align = 4, size = 4;
+};
+template <>
+struct Rules<glm::vec2> {
+  static constexpr std::size_t align = 8, size = 8;
+};
+template <>
+struct Rules<glm::vec3> {
+  static constexpr std::size_t align = 16, size = 12;
+};
+template <>
+struct Rules<glm::vec4> {
+  static constexpr std::size_t align = 16, size = 16;
+};
+template <>
+struct Rules<glm::mat4> {
+  static constexpr std::size_t align = 16, size = 64;
+};
+
+constexpr std::size_t alignUp(std::size_t offset, std::size_t align) {
+  return (offset + align - 1) & ~(align - 1);
+}
+
+// Lays out members one after the other the way GLSL does for a std140 block, so a C++
+// struct can be checked against it, e.g.
+//   static_assert(std140::Layout().add<glm::mat4>().add<glm::vec3>().size() == 80, "");
+class Layout {
+ public:
+  constexpr Layout() : end(0), last(0) {}
+
+  template <typename T>
+  constexpr Layout add() const {
+    return Layout(alignUp(end, Rules<T>::align) + Rules<T>::size,
+                  alignUp(end, Rules<T>::align));
+  }
+  // offset of the member added last
+  constexpr std::size_t offset() const { return last; }
+  // the block's size as GL_UNIFORM_BLOCK_DATA_SIZE reports it (rounded up to a vec4)
+  constexpr std::size_t size() const { return alignUp(end, 16); }
+
+ private:
+  constexpr Layout(std::size_t end, std::size_t last) : end(end), last(last) {}
+  std::size_t end;
+  std::size_t last;
+};
+
+}  // namespace std140
+
+// Binding point for a named uniform block. Every block name gets one binding point for the
+// whole process, handed out on first use, so a buffer bound there is seen by every program
+// that declares a block of that name. Shader wires its blocks up through this after linking.
+// Once the GL's binding points are all taken, new names get NO_UNIFORM_BLOCK_BINDING (and a
+// message) instead; blocks given it are left unbound.
+const unsigned int NO_UNIFORM_BLOCK_BINDING = 0xFFFFFFFFu;
+unsigned int uniformBlockBinding(const char *blockName);
+
+// A uniform block's data bound to the binding point of `blockName`. Each update() writes a
+// fresh copy into the next region of a StreamBuffer and binds that range, so an update never
+// waits on draws still reading an earlier copy and nothing is reallocated. Meant for one
+// update a frame; more than `frames` updates a frame make it wait on the GPU.
+// Like the other GL wrappers here it's a handle; release() deletes the buffer.
+class UniformBuffer {
+ public:
+  unsigned int binding;
+
+  // GL thread
+  UniformBuffer(const char *blockName, std::size_t size, unsigned int frames = 3);
+  UniformBuffer(const UniformBuffer &) = delete;
+  UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+  // replaces the contents; `bytes` past the end of the block are ignored
+  void update(const void *data, std::size_t bytes);
+  template <typename T>
+  void update(const T &block) {
+    update(&block, sizeof(T));
+  }
+  // (re)binds the latest copy to its binding point, e.g. after something else used the slot
+  void bind() const;
+
+  // GL thread: deletes the buffer
+  void release();
+
+ private:
+  std::size_t size;
+  StreamBuffer stream;
+  // of the latest copy in the stream
+  std::size_t current;
+};
+
+// Per-frame camera data shared by every program that declares
+//   layout (std140) uniform FrameConstants { mat4 view; mat4 projection; };
+struct FrameConstants {
+  glm::mat4 view;
+  glm::mat4 projection;
+};
+static_assert(offsetof(FrameConstants, view) ==
+                  std140::Layout().add<glm::mat4>().offset(),
+              "FrameConstants::view doesn't match std140");
+static_assert(offsetof(FrameConstants, projection) ==
+                  std140::Layout().add<glm::mat4>().add<glm::mat4>().offset(),
+              "FrameConstants::projection doesn't match std140");
+static_assert(sizeof(FrameConstants) ==
+                  std140::Layout().add<glm::mat4>().add<glm::mat4>().size(),
+              "FrameConstants size doesn't match std140");
+
+// the FrameConstants block, uploaded once per frame and read by all programs
+class FrameConstantsBuffer : public UniformBuffer {
+ public:
+  FrameConstantsBuffer() : UniformBuffer("FrameConstants", sizeof(FrameConstants)) {}
+  void update(const glm::mat4 &view, const glm::mat4 &projection) {
+    FrameConstants constants = {view, projection};
+    UniformBuffer::update(constants);
+  }
+};
+#endif
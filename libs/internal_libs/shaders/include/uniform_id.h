@@ -0,0 +1,24 @@
+#ifndef UNIFORM_ID_H
+#define UNIFORM_ID_H
+
+#include "fnv1a.h"
+
+#include <cstdint>
+#include <type_traits>
+
+// Handle for a uniform, identified by the FNV-1a hash of its name. Shader resolves it
+// through a flat table built at link time, so setting a uniform never touches a string.
+struct UniformId {
+  std::uint32_t hash;
+
+  // 0 marks an empty slot in Shader's table, so it is folded onto 1
+  constexpr explicit UniformId(std::uint32_t nameHash) : hash(nameHash != 0 ? nameHash : 1) {}
+};
+
+// hashes at runtime; prefer UID() for names known at compile time
+inline UniformId uniformId(const char *name) { return UniformId(fnv1a32(name)); }
+
+// UID("model") is hashed by the compiler: the integral_constant forces constant evaluation
+#define UID(name) UniformId(std::integral_constant<std::uint32_t, fnv1a32(name)>::value)
+
+#endif
@@ -0,0 +1,80 @@
+#include "gl_ext.h"
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstring>
+
+namespace {
+
+template <typename Fn>
+Fn loadProc(const char* name) {
+  return reinterpret_cast<Fn>(glfwGetProcAddress(name));
+}
+
+GLExtensions queryExtensions() {
+  GLExtensions ext;
+  glGetIntegerv(GL_MAJOR_VERSION, &ext.majorVersion);
+  glGetIntegerv(GL_MINOR_VERSION, &ext.minorVersion);
+
+  if (ext.hasVersion(4, 1) || ext.hasExtension("GL_ARB_get_program_binary")) {
+    ext.getProgramBinary = loadProc<GLGetProgramBinaryFn>("glGetProgramBinary");
+    ext.programBinaryLoad = loadProc<GLProgramBinaryFn>("glProgramBinary");
+    ext.programParameteri = loadProc<GLProgramParameteriFn>("glProgramParameteri");
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    // some drivers expose the entry points but no formats, which makes them useless
+    ext.programBinary = ext.getProgramBinary && ext.programBinaryLoad &&
+                        ext.programParameteri && formats > 0;
+  }
+
+  if (ext.hasExtension("GL_KHR_parallel_shader_compile")) {
+    ext.maxShaderCompilerThreads =
+        loadProc<GLMaxShaderCompilerThreadsFn>("glMaxShaderCompilerThreadsKHR");
+  } else if (ext.hasExtension("GL_ARB_parallel_shader_compile")) {
+    ext.maxShaderCompilerThreads =
+        loadProc<GLMaxShaderCompilerThreadsFn>("glMaxShaderCompilerThreadsARB");
+  }
+  ext.parallelShaderCompile = ext.maxShaderCompilerThreads != nullptr;
+
+  if (ext.hasVersion(4, 4) || ext.hasExtension("GL_ARB_buffer_storage")) {
+    ext.bufferStorageData = loadProc<GLBufferStorageFn>("glBufferStorage");
+  }
+  ext.bufferStorage = ext.bufferStorageData != nullptr;
+
+  // before GL 4.2 / ARB_base_instance a command's baseInstance must be 0, and per-object
+  // data is found through it
+  bool baseInstance = ext.hasVersion(4, 2) || ext.hasExtension("GL_ARB_base_instance");
+  if (ext.hasVersion(4, 3) ||
+      (baseInstance && ext.hasExtension("GL_ARB_multi_draw_indirect"))) {
+    ext.multiDrawElementsIndirect =
+        loadProc<GLMultiDrawElementsIndirectFn>("glMultiDrawElementsIndirect");
+  }
+  ext.multiDrawIndirect = ext.multiDrawElementsIndirect != nullptr;
+
+  // S3TC never made it into core, but every desktop driver has it
+  ext.textureCompressionS3TC = ext.hasExtension("GL_EXT_texture_compression_s3tc");
+  ext.textureCompressionBPTC =
+      ext.hasVersion(4, 2) || ext.hasExtension("GL_ARB_texture_compression_bptc");
+  return ext;
+}
+
+}  // namespace
+
+bool GLExtensions::hasVersion(int major, int minor) const {
+  return majorVersion > major || (majorVersion == major && minorVersion >= minor);
+}
+
+bool GLExtensions::hasExtension(const char* name) const {
+  int count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for (int i = 0; i < count; i++) {
+    const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+    if (extension && std::strcmp(extension, name) == 0) return true;
+  }
+  return false;
+}
+
+const GLExtensions& glExtensions() {
+  static const GLExtensions ext = queryExtensions();
+  return ext;
+}
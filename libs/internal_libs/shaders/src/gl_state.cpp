@@ -0,0 +1,150 @@
+#include "gl_state.h"
+#include <glad/glad.h>
+
+namespace {
+
+// stands in for "not known", never a name GL hands out in practice
+const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+int textureTargetIndex(GLenum target) {
+  switch (target) {
+    case GL_TEXTURE_2D:
+      return 0;
+    case GL_TEXTURE_2D_ARRAY:
+      return 1;
+    case GL_TEXTURE_3D:
+      return 2;
+    case GL_TEXTURE_CUBE_MAP:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+int capabilityIndex(GLenum capability) {
+  switch (capability) {
+    case GL_BLEND:
+      return 0;
+    case GL_DEPTH_TEST:
+      return 1;
+    case GL_CULL_FACE:
+      return 2;
+    case GL_SCISSOR_TEST:
+      return 3;
+    case GL_STENCIL_TEST:
+      return 4;
+    default:
+      return -1;
+  }
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+unsigned long long GLStateCounters::totalIssued() const {
+  unsigned long long total = 0;
+  for (unsigned long long count : issued) total += count;
+  return total;
+}
+// ------------------------------------------------------------------------
+unsigned long long GLStateCounters::totalElided() const {
+  unsigned long long total = 0;
+  for (unsigned long long count : elided) total += count;
+  return total;
+}
+// ------------------------------------------------------------------------
+GLState::GLState() {
+  invalidate();
+  resetCounters();
+}
+// count the call and tell the caller whether it has to reach the driver
+// ------------------------------------------------------------------------
+bool GLState::changed(GLStateCall call, bool needed) {
+  if (needed) {
+    stats.issued[(int)call]++;
+  } else {
+    stats.elided[(int)call]++;
+  }
+  return needed;
+}
+// ------------------------------------------------------------------------
+void GLState::useProgram(unsigned int program) {
+  if (!changed(GLStateCall::UseProgram, this->program != program)) return;
+  glUseProgram(program);
+  this->program = program;
+}
+// ------------------------------------------------------------------------
+void GLState::bindVertexArray(unsigned int vao) {
+  if (!changed(GLStateCall::BindVertexArray, vertexArray != vao)) return;
+  glBindVertexArray(vao);
+  vertexArray = vao;
+}
+// ------------------------------------------------------------------------
+void GLState::activeTexture(GLenum unit) {
+  int index = (int)(unit - GL_TEXTURE0);
+  if (!changed(GLStateCall::ActiveTexture, activeUnit != index)) return;
+  glActiveTexture(unit);
+  // units past the ones we track are set, but leave the active unit unknown
+  activeUnit = index < TEXTURE_UNITS ? index : -1;
+}
+// ------------------------------------------------------------------------
+void GLState::bindTexture(GLenum target, unsigned int texture) {
+  int targetIndex = textureTargetIndex(target);
+  if (activeUnit < 0 || targetIndex < 0) {
+    changed(GLStateCall::BindTexture, true);
+    glBindTexture(target, texture);
+    return;
+  }
+  unsigned int& bound = textures[activeUnit][targetIndex];
+  if (!changed(GLStateCall::BindTexture, bound != texture)) return;
+  glBindTexture(target, texture);
+  bound = texture;
+}
+// ------------------------------------------------------------------------
+void GLState::enable(GLenum capability) { setCapability(capability, true); }
+void GLState::disable(GLenum capability) { setCapability(capability, false); }
+
+void GLState::setCapability(GLenum capability, bool enabled) {
+  int index = capabilityIndex(capability);
+  bool needed = index < 0 || capabilities[index] != (enabled ? 1 : 0);
+  if (!changed(GLStateCall::Capability, needed)) return;
+  if (enabled) {
+    glEnable(capability);
+  } else {
+    glDisable(capability);
+  }
+  if (index >= 0) capabilities[index] = enabled ? 1 : 0;
+}
+// ------------------------------------------------------------------------
+void GLState::forgetProgram(unsigned int program) {
+  if (this->program == program) this->program = UNKNOWN;
+}
+void GLState::forgetVertexArray(unsigned int vao) {
+  if (vertexArray == vao) vertexArray = UNKNOWN;
+}
+void GLState::forgetTexture(unsigned int texture) {
+  for (auto& unit : textures) {
+    for (unsigned int& bound : unit) {
+      if (bound == texture) bound = UNKNOWN;
+    }
+  }
+}
+// ------------------------------------------------------------------------
+void GLState::invalidate() {
+  program = UNKNOWN;
+  vertexArray = UNKNOWN;
+  activeUnit = -1;
+  for (auto& unit : textures) {
+    for (unsigned int& bound : unit) bound = UNKNOWN;
+  }
+  for (signed char& capability : capabilities) capability = -1;
+}
+// ------------------------------------------------------------------------
+const GLStateCounters& GLState::counters() const { return stats; }
+
+void GLState::resetCounters() { stats = GLStateCounters(); }
+// ------------------------------------------------------------------------
+GLState& glState() {
+  static GLState state;
+  return state;
+}
@@ -0,0 +1,122 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ------------------------------------------------------------------------
+MappedFile::MappedFile()
+    : bytes(nullptr),
+      length(0),
+      open(false)
+#ifdef _WIN32
+      ,
+      fileHandle(nullptr),
+      mappingHandle(nullptr)
+#endif
+{
+}
+
+#ifdef _WIN32
+// ------------------------------------------------------------------------
+MappedFile::MappedFile(const std::string& path) : MappedFile() {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) return;
+  fileHandle = file;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    close();
+    return;
+  }
+  length = (std::size_t)fileSize.QuadPart;
+  open = true;
+  // zero-length files can't be mapped, but they are perfectly valid (and empty)
+  if (length == 0) return;
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL) {
+    close();
+    return;
+  }
+  mappingHandle = mapping;
+  bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (bytes == nullptr) close();
+}
+// ------------------------------------------------------------------------
+void MappedFile::close() {
+  if (bytes) UnmapViewOfFile(bytes);
+  if (mappingHandle) CloseHandle(mappingHandle);
+  if (fileHandle) CloseHandle(fileHandle);
+  bytes = nullptr;
+  mappingHandle = nullptr;
+  fileHandle = nullptr;
+  length = 0;
+  open = false;
+}
+#else
+// ------------------------------------------------------------------------
+MappedFile::MappedFile(const std::string& path) : MappedFile() {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return;
+  struct stat info;
+  if (fstat(fd, &info) == 0) {
+    length = (std::size_t)info.st_size;
+    open = true;
+    // zero-length files can't be mapped, but they are perfectly valid (and empty)
+    if (length > 0) {
+      void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        bytes = (const unsigned char*)mapping;
+      } else {
+        length = 0;
+        open = false;
+      }
+    }
+  }
+  // the mapping keeps its own reference to the file
+  ::close(fd);
+}
+// ------------------------------------------------------------------------
+void MappedFile::close() {
+  if (bytes) munmap((void*)bytes, length);
+  bytes = nullptr;
+  length = 0;
+  open = false;
+}
+#endif
+
+// ------------------------------------------------------------------------
+MappedFile::~MappedFile() { close(); }
+// ------------------------------------------------------------------------
+MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile() { *this = std::move(other); }
+// ------------------------------------------------------------------------
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    close();
+    std::swap(bytes, other.bytes);
+    std::swap(length, other.length);
+    std::swap(open, other.open);
+#ifdef _WIN32
+    std::swap(fileHandle, other.fileHandle);
+    std::swap(mappingHandle, other.mappingHandle);
+#endif
+  }
+  return *this;
+}
+// ------------------------------------------------------------------------
+bool MappedFile::isOpen() const { return open; }
+const unsigned char* MappedFile::data() const { return bytes; }
+std::size_t MappedFile::size() const { return length; }
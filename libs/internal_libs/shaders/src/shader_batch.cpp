@@ -0,0 +1,110 @@
+#include "shader_batch.h"
+#include "gl_ext.h"
+#include <glad/glad.h>
+
+#include <utility>
+
+// ------------------------------------------------------------------------
+void ShaderBatch::add(Shader& shader, const char* vertexPath, const char* fragmentPath) {
+  Job job;
+  job.shader = &shader;
+  job.vertexSource = ShaderSource::fromFile(vertexPath);
+  job.fragmentSource = ShaderSource::fromFile(fragmentPath);
+  shader.vertexPath = vertexPath;
+  shader.fragmentPath = fragmentPath;
+  jobs.push_back(std::move(job));
+}
+// ------------------------------------------------------------------------
+void ShaderBatch::submit() {
+  const GLExtensions& ext = glExtensions();
+  // 0xFFFFFFFF lets the driver pick its own thread count
+  if (ext.parallelShaderCompile) ext.maxShaderCompilerThreads(0xFFFFFFFFu);
+
+  bool useBinaryCache = Shader::binaryCacheEnabled();
+  // cached binaries first; glProgramBinary is asynchronous too under the extension
+  for (Job& job : jobs) {
+    if (job.state != State::Queued || !useBinaryCache) continue;
+    job.cacheKey = Shader::programCacheKey(job.vertexSource, job.fragmentSource);
+    job.program = Shader::createProgramFromBinary(job.cacheKey);
+    job.fromBinary = job.program != 0;
+  }
+  // then every compile, then every link, so no link sits between two compiles
+  for (Job& job : jobs) {
+    if (job.state == State::Queued && !job.fromBinary) compile(job);
+  }
+  for (Job& job : jobs) {
+    if (job.state != State::Queued) continue;
+    if (!job.fromBinary) link(job);
+    job.state = State::InFlight;
+  }
+}
+// ------------------------------------------------------------------------
+bool ShaderBatch::poll() {
+  bool parallel = glExtensions().parallelShaderCompile;
+  for (Job& job : jobs) {
+    if (job.state != State::InFlight) continue;
+    if (parallel) {
+      int completed = 0;
+      glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &completed);
+      if (!completed) continue;
+    }
+    complete(job);
+  }
+  return pending() == 0;
+}
+// ------------------------------------------------------------------------
+void ShaderBatch::finish() {
+  // a rejected binary turns into a fresh compile, so one pass may not be enough
+  while (pending() != 0) {
+    for (Job& job : jobs) {
+      if (job.state == State::InFlight) complete(job);
+    }
+  }
+}
+// ------------------------------------------------------------------------
+std::size_t ShaderBatch::pending() const {
+  std::size_t count = 0;
+  for (const Job& job : jobs) {
+    if (job.state == State::InFlight) count++;
+  }
+  return count;
+}
+// ------------------------------------------------------------------------
+void ShaderBatch::compile(Job& job) {
+  job.vertex = Shader::compileShader(GL_VERTEX_SHADER, job.vertexSource);
+  job.fragment = Shader::compileShader(GL_FRAGMENT_SHADER, job.fragmentSource);
+}
+// ------------------------------------------------------------------------
+void ShaderBatch::link(Job& job) {
+  job.program = Shader::linkProgram(job.vertex, job.fragment, Shader::binaryCacheEnabled());
+}
+// the program has finished (or we're willing to wait for it): check it and hand it over
+// ------------------------------------------------------------------------
+void ShaderBatch::complete(Job& job) {
+  if (job.fromBinary) {
+    int success = 0;
+    glGetProgramiv(job.program, GL_LINK_STATUS, &success);
+    if (!success) {
+      // stale binary; fall back to the sources and stay in flight
+      glDeleteProgram(job.program);
+      job.fromBinary = false;
+      compile(job);
+      link(job);
+      return;
+    }
+  } else {
+    Shader::checkCompileErrors(job.vertex, "VERTEX");
+    Shader::checkCompileErrors(job.fragment, "FRAGMENT");
+    if (Shader::checkCompileErrors(job.program, "PROGRAM") && Shader::binaryCacheEnabled()) {
+      Shader::storeProgramBinary(job.program, job.cacheKey);
+    }
+    glDeleteShader(job.vertex);
+    glDeleteShader(job.fragment);
+  }
+  job.shader->ID = job.program;
+  job.shader->cacheUniformLocations();
+  job.shader->bindUniformBlocks();
+  job.vertexSource = ShaderSource();
+  job.fragmentSource = ShaderSource();
+  job.state = State::Done;
+}
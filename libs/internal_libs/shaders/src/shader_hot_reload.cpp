@@ -0,0 +1,176 @@
+#include "shader_hot_reload.h"
+#include "shader_s.h"
+#include "gl_ext.h"
+#include <glad/glad.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// editors tend to save in several steps (truncate, write, rename); give them a moment
+const std::chrono::milliseconds SETTLE_TIME(50);
+
+// an empty file is an editor halfway through a save, not a shader
+bool readText(const std::string& path, std::string& text) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  std::stringstream contents;
+  contents << file.rdbuf();
+  text = contents.str();
+  return !text.empty();
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+ShaderHotReload::ShaderHotReload(const std::string& vertexPath, const std::string& fragmentPath)
+    : vertexPath(vertexPath),
+      fragmentPath(fragmentPath),
+      sourcesPending(false),
+      running(true),
+      vertex(0),
+      fragment(0),
+      program(0) {
+  watcher = std::thread(&ShaderHotReload::watch, this);
+}
+// ------------------------------------------------------------------------
+ShaderHotReload::~ShaderHotReload() {
+  running = false;
+  watcher.join();
+  if (program != 0) {
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    glDeleteProgram(program);
+  }
+}
+// ------------------------------------------------------------------------
+unsigned int ShaderHotReload::poll() {
+  if (program == 0) {
+    std::string vertexCode;
+    std::string fragmentCode;
+    if (!takeSources(vertexCode, fragmentCode)) return 0;
+    vertex = Shader::compileShader(GL_VERTEX_SHADER,
+                                   ShaderSource::fromMemory(vertexCode.data(), vertexCode.size()));
+    fragment = Shader::compileShader(
+        GL_FRAGMENT_SHADER, ShaderSource::fromMemory(fragmentCode.data(), fragmentCode.size()));
+    program = Shader::linkProgram(vertex, fragment, false);
+    // without parallel compile the status query blocks, so at least leave it to next frame
+    if (!glExtensions().parallelShaderCompile) return 0;
+  }
+  if (glExtensions().parallelShaderCompile) {
+    int completed = 0;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &completed);
+    if (!completed) return 0;
+  }
+  // check all three so every error gets printed
+  bool vertexOk = Shader::checkCompileErrors(vertex, "VERTEX");
+  bool fragmentOk = Shader::checkCompileErrors(fragment, "FRAGMENT");
+  bool linked = Shader::checkCompileErrors(program, "PROGRAM");
+  glDeleteShader(vertex);
+  glDeleteShader(fragment);
+  unsigned int result = program;
+  vertex = fragment = program = 0;
+  if (!(vertexOk && fragmentOk && linked)) {
+    std::cout << "ERROR::SHADER::HOT_RELOAD_FAILED: keeping the previous program" << std::endl;
+    glDeleteProgram(result);
+    return 0;
+  }
+  return result;
+}
+// Read with plain file reads, not ShaderSource's mapping: this runs exactly while an editor
+// is saving, and if the file is truncated under a mapping, touching a page past the new end
+// raises SIGBUS. A read just comes back short, and the next change event reads it again.
+// ------------------------------------------------------------------------
+void ShaderHotReload::readSources() {
+  std::string vertexCode, fragmentCode;
+  if (!readText(vertexPath, vertexCode) || !readText(fragmentPath, fragmentCode)) return;
+  std::lock_guard<std::mutex> lock(sourceMutex);
+  pendingVertexCode.swap(vertexCode);
+  pendingFragmentCode.swap(fragmentCode);
+  sourcesPending = true;
+}
+// never waits for the watcher: if it is busy publishing, try again next frame
+// ------------------------------------------------------------------------
+bool ShaderHotReload::takeSources(std::string& vertexCode, std::string& fragmentCode) {
+  std::unique_lock<std::mutex> lock(sourceMutex, std::try_to_lock);
+  if (!lock.owns_lock() || !sourcesPending) return false;
+  vertexCode.swap(pendingVertexCode);
+  fragmentCode.swap(pendingFragmentCode);
+  sourcesPending = false;
+  return true;
+}
+
+#ifdef __linux__
+// watch the parent directories rather than the files, since editors often replace a file
+// by renaming a new one over it, which would silently drop a watch on the old inode
+// ------------------------------------------------------------------------
+void ShaderHotReload::watch() {
+  namespace fs = std::filesystem;
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    std::cout << "ERROR::SHADER::HOT_RELOAD: inotify unavailable" << std::endl;
+    return;
+  }
+  const std::string paths[] = {vertexPath, fragmentPath};
+  std::string names[2];
+  for (int i = 0; i < 2; i++) {
+    fs::path path(paths[i]);
+    names[i] = path.filename().string();
+    fs::path directory = path.parent_path().empty() ? fs::path(".") : path.parent_path();
+    inotify_add_watch(fd, directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+  }
+
+  alignas(struct inotify_event) char buffer[4096];
+  while (running) {
+    pollfd pfd = {fd, POLLIN, 0};
+    // the timeout only bounds how long shutdown can take
+    if (::poll(&pfd, 1, 100) <= 0) continue;
+    bool changed = false;
+    ssize_t length;
+    while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+      for (char* p = buffer; p < buffer + length;) {
+        const inotify_event* event = (const inotify_event*)p;
+        if (event->len > 0 && (names[0] == event->name || names[1] == event->name)) {
+          changed = true;
+        }
+        p += sizeof(inotify_event) + event->len;
+      }
+    }
+    if (!changed) continue;
+    // swallow whatever else the save produces, then reload once
+    std::this_thread::sleep_for(SETTLE_TIME);
+    while (read(fd, buffer, sizeof(buffer)) > 0) {
+    }
+    readSources();
+  }
+  close(fd);
+}
+#else
+// ------------------------------------------------------------------------
+void ShaderHotReload::watch() {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  fs::file_time_type vertexTime = fs::last_write_time(vertexPath, error);
+  fs::file_time_type fragmentTime = fs::last_write_time(fragmentPath, error);
+  while (running) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    fs::file_time_type newVertexTime = fs::last_write_time(vertexPath, error);
+    fs::file_time_type newFragmentTime = fs::last_write_time(fragmentPath, error);
+    if (newVertexTime == vertexTime && newFragmentTime == fragmentTime) continue;
+    vertexTime = newVertexTime;
+    fragmentTime = newFragmentTime;
+    std::this_thread::sleep_for(SETTLE_TIME);
+    readSources();
+  }
+}
+#endif
@@ -1,86 +1,358 @@
 #include "shader_s.h"
+#include "shader_hot_reload.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "uniform_buffer.h"
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include <string>
 #include <fstream>
-#include <sstream>
 #include <iostream>
+#include <filesystem>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// in the build tree by default (see CMakeLists.txt), so it doesn't follow the working directory
+#ifndef SHADER_CACHE_DIR
+#define SHADER_CACHE_DIR "shader_cache"
+#endif
+std::string Shader::binaryCacheDirectory = SHADER_CACHE_DIR;
+
+namespace {
+
+// on-disk layout of a cached program: this header followed by `length` bytes of binary
+struct ProgramBinaryHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint64_t key;
+  std::uint32_t format;
+  std::uint32_t length;
+};
+const char PROGRAM_BINARY_MAGIC[4] = {'G', 'L', 'P', 'B'};
+const std::uint32_t PROGRAM_BINARY_VERSION = 1;
+
+std::string programCachePath(const std::string& directory, std::uint64_t key) {
+  char fileName[32];
+  std::snprintf(fileName, sizeof(fileName), "%016llx.bin", (unsigned long long)key);
+  return (std::filesystem::path(directory) / fileName).string();
+}
+
+}  // namespace
 
 // constructor generates the shader on the fly
 // ------------------------------------------------------------------------
-Shader::Shader(const char* vertexPath, const char* fragmentPath) {
-  // 1. retrieve the vertex/fragment source code from filePath
-  std::string vertexCode;
-  std::string fragmentCode;
-  std::ifstream vShaderFile;
-  std::ifstream fShaderFile;
-  // ensure ifstream objects can throw exceptions:
-  vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-  fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-  try {
-    // open files
-    vShaderFile.open(vertexPath);
-    fShaderFile.open(fragmentPath);
-    std::stringstream vShaderStream, fShaderStream;
-    // read file's buffer contents into streams
-    vShaderStream << vShaderFile.rdbuf();
-    fShaderStream << fShaderFile.rdbuf();
-    // close file handlers
-    vShaderFile.close();
-    fShaderFile.close();
-    // convert stream into string
-    vertexCode = vShaderStream.str();
-    fragmentCode = fShaderStream.str();
-  } catch (std::ifstream::failure& e) {
-    std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+Shader::Shader(const char* vertexPath, const char* fragmentPath)
+    : Shader(ShaderSource::fromFile(vertexPath), ShaderSource::fromFile(fragmentPath)) {
+  this->vertexPath = vertexPath;
+  this->fragmentPath = fragmentPath;
+}
+// ------------------------------------------------------------------------
+Shader::Shader(const ShaderSource& vertexSource, const ShaderSource& fragmentSource) : ID(0) {
+  // 1. skip the GLSL compiler entirely if this program was linked on a previous run
+  bool useBinaryCache = binaryCacheEnabled();
+  std::uint64_t cacheKey = 0;
+  if (useBinaryCache) {
+    cacheKey = programCacheKey(vertexSource, fragmentSource);
+    ID = createProgramFromBinary(cacheKey);
+    int success = 0;
+    if (ID != 0) glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    if (success) {
+      cacheUniformLocations();
+      bindUniformBlocks();
+      return;
+    }
+    // driver updates routinely invalidate old binaries; recompiling refreshes the cache
+    if (ID != 0) glDeleteProgram(ID);
   }
-  const char* vShaderCode = vertexCode.c_str();
-  const char* fShaderCode = fragmentCode.c_str();
   // 2. compile shaders
-  unsigned int vertex, fragment;
-  // vertex shader
-  vertex = glCreateShader(GL_VERTEX_SHADER);
-  glShaderSource(vertex, 1, &vShaderCode, NULL);
-  glCompileShader(vertex);
+  unsigned int vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
   checkCompileErrors(vertex, "VERTEX");
-  // fragment Shader
-  fragment = glCreateShader(GL_FRAGMENT_SHADER);
-  glShaderSource(fragment, 1, &fShaderCode, NULL);
-  glCompileShader(fragment);
+  unsigned int fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
   checkCompileErrors(fragment, "FRAGMENT");
   // shader Program
-  ID = glCreateProgram();
-  glAttachShader(ID, vertex);
-  glAttachShader(ID, fragment);
-  glLinkProgram(ID);
-  checkCompileErrors(ID, "PROGRAM");
+  ID = linkProgram(vertex, fragment, useBinaryCache);
+  if (checkCompileErrors(ID, "PROGRAM") && useBinaryCache) storeProgramBinary(ID, cacheKey);
+  cacheUniformLocations();
+  bindUniformBlocks();
   // delete the shaders as they're linked into our program now and no longer necessary
   glDeleteShader(vertex);
   glDeleteShader(fragment);
 }
+// empty shader, to be filled in by ShaderBatch
+// ------------------------------------------------------------------------
+Shader::Shader() : ID(0) {}
+// ------------------------------------------------------------------------
+Shader::~Shader() = default;
+Shader::Shader(Shader&& other) noexcept = default;
+Shader& Shader::operator=(Shader&& other) noexcept = default;
+// ------------------------------------------------------------------------
+bool Shader::ready() const { return ID != 0; }
+// ------------------------------------------------------------------------
+void Shader::enableHotReload() {
+  if (vertexPath.empty() || fragmentPath.empty()) {
+    std::cout << "ERROR::SHADER::HOT_RELOAD: no source files to watch" << std::endl;
+    return;
+  }
+  enableHotReload(vertexPath.c_str(), fragmentPath.c_str());
+}
+void Shader::enableHotReload(const char* vertexPath, const char* fragmentPath) {
+  hotReload.reset(new ShaderHotReload(vertexPath, fragmentPath));
+}
+// ------------------------------------------------------------------------
+bool Shader::pollHotReload() {
+  if (!hotReload) return false;
+  unsigned int program = hotReload->poll();
+  if (program == 0) return false;
+  glState().forgetProgram(ID);
+  glDeleteProgram(ID);
+  ID = program;
+  cacheUniformLocations();
+  bindUniformBlocks();
+  return true;
+}
+// create and compile a shader stage without waiting for the result
+// ------------------------------------------------------------------------
+unsigned int Shader::compileShader(GLenum type, const ShaderSource& source) {
+  unsigned int shader = glCreateShader(type);
+  // explicit length: the source is used in place and needn't be null terminated
+  const char* code = source.data();
+  GLint length = (GLint)source.size();
+  glShaderSource(shader, 1, &code, &length);
+  glCompileShader(shader);
+  return shader;
+}
+// create and link a program without waiting for the result
+// ------------------------------------------------------------------------
+unsigned int Shader::linkProgram(unsigned int vertex, unsigned int fragment, bool retrievable) {
+  unsigned int program = glCreateProgram();
+  glAttachShader(program, vertex);
+  glAttachShader(program, fragment);
+  if (retrievable) {
+    glExtensions().programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+  glLinkProgram(program);
+  return program;
+}
+// point the program binary cache somewhere else (or nowhere, with an empty path)
+// ------------------------------------------------------------------------
+void Shader::setBinaryCacheDirectory(const std::string& directory) {
+  binaryCacheDirectory = directory;
+}
+// ------------------------------------------------------------------------
+bool Shader::binaryCacheEnabled() {
+  return glExtensions().programBinary && !binaryCacheDirectory.empty();
+}
+// a binary is only valid for the exact sources on the exact driver that produced it
+// ------------------------------------------------------------------------
+std::uint64_t Shader::programCacheKey(const ShaderSource& vertexSource,
+                                      const ShaderSource& fragmentSource) {
+  std::uint64_t key = fnv1a64Bytes(vertexSource.data(), vertexSource.size());
+  key = fnv1a64Bytes(fragmentSource.data(), fragmentSource.size(), key);
+  const GLenum driverStrings[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+  for (GLenum name : driverStrings) {
+    const char* value = (const char*)glGetString(name);
+    if (value) key = fnv1a64Bytes(value, std::strlen(value), key);
+  }
+  return key;
+}
+// create a program from a cached binary, or return 0 if there is none. The caller checks
+// GL_LINK_STATUS, which is false when the driver rejects the blob.
+// ------------------------------------------------------------------------
+unsigned int Shader::createProgramFromBinary(std::uint64_t key) {
+  std::ifstream file(programCachePath(binaryCacheDirectory, key),
+                     std::ios::binary | std::ios::ate);
+  if (!file) return 0;
+  std::streamoff fileSize = file.tellg();
+  file.seekg(0);
+  ProgramBinaryHeader header;
+  if (!file.read((char*)&header, sizeof(header))) return 0;
+  // a length past the end of the file is a truncated or corrupt entry, not an allocation
+  // size to trust
+  if (std::memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) != 0 ||
+      header.version != PROGRAM_BINARY_VERSION || header.key != key || header.length == 0 ||
+      header.length > (std::uint64_t)(fileSize - (std::streamoff)sizeof(header))) {
+    return 0;
+  }
+  std::vector<char> binary(header.length);
+  if (!file.read(binary.data(), binary.size())) return 0;
+
+  unsigned int program = glCreateProgram();
+  glExtensions().programBinaryLoad(program, header.format, binary.data(), (GLsizei)binary.size());
+  return program;
+}
+// write a linked program out so the next run can skip compilation
+// ------------------------------------------------------------------------
+void Shader::storeProgramBinary(unsigned int program, std::uint64_t key) {
+  int length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) return;
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glExtensions().getProgramBinary(program, length, &length, &format, binary.data());
+
+  std::error_code error;
+  std::filesystem::create_directories(binaryCacheDirectory, error);
+  std::string path = programCachePath(binaryCacheDirectory, key);
+  // write to a temporary first so a crash can't leave a truncated binary behind
+  std::string tempPath = path + ".tmp";
+  {
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    if (!file) return;
+    ProgramBinaryHeader header;
+    std::memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+    header.version = PROGRAM_BINARY_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = (std::uint32_t)length;
+    file.write((const char*)&header, sizeof(header));
+    file.write(binary.data(), length);
+    if (!file) return;
+  }
+  std::filesystem::rename(tempPath, path, error);
+}
 // activate the shader
 // ------------------------------------------------------------------------
-void Shader::use() { glUseProgram(ID); }
+void Shader::use() { glState().useProgram(ID); }
+// look up every active uniform once so the set* calls never have to ask the driver
+// ------------------------------------------------------------------------
+void Shader::cacheUniformLocations() {
+  int count = 0;
+  int maxLength = 0;
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+  // arrays are reported once as "name[0]" with their size; every element gets its own entry,
+  // and the bare name resolves to element 0 as it does in GL. Element locations aren't
+  // guaranteed to be consecutive, so each is asked for once here.
+  std::vector<std::pair<std::string, int>> entries;
+  std::string name(maxLength > 0 ? maxLength : 1, '\0');
+  for (int i = 0; i < count; i++) {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(ID, i, (GLsizei)name.size(), &length, &size, &type, &name[0]);
+    std::string uniform(name.c_str(), length);
+    int location = glGetUniformLocation(ID, uniform.c_str());
+    // members of uniform blocks have no location of their own
+    if (location < 0) continue;
+    entries.emplace_back(uniform, location);
+    const std::string firstElement = "[0]";
+    if (uniform.size() <= firstElement.size() ||
+        uniform.compare(uniform.size() - firstElement.size(), firstElement.size(),
+                        firstElement) != 0) {
+      continue;
+    }
+    std::string base = uniform.substr(0, uniform.size() - firstElement.size());
+    entries.emplace_back(base, location);
+    for (GLint element = 1; element < size; element++) {
+      std::string elementName = base + "[" + std::to_string(element) + "]";
+      int elementLocation = glGetUniformLocation(ID, elementName.c_str());
+      if (elementLocation >= 0) entries.emplace_back(elementName, elementLocation);
+    }
+  }
+
+  // the table stays at most half full
+  std::size_t capacity = 1;
+  while (capacity < entries.size() * 2) capacity <<= 1;
+  uniformSlots.assign(capacity, UniformSlot{0, -1});
+  for (const std::pair<std::string, int>& entry : entries) {
+    insertUniform(entry.first.c_str(), entry.second);
+  }
+}
+// point every active uniform block at the binding shared by all blocks of that name
+// ------------------------------------------------------------------------
+void Shader::bindUniformBlocks() {
+  int count = 0;
+  int maxLength = 0;
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+  glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+  std::string name(maxLength > 0 ? maxLength : 1, '\0');
+  for (int i = 0; i < count; i++) {
+    GLsizei length = 0;
+    glGetActiveUniformBlockName(ID, i, (GLsizei)name.size(), &length, &name[0]);
+    name[length] = '\0';
+    unsigned int binding = uniformBlockBinding(name.c_str());
+    if (binding != NO_UNIFORM_BLOCK_BINDING) glUniformBlockBinding(ID, i, binding);
+  }
+}
+// ------------------------------------------------------------------------
+void Shader::insertUniform(const char* name, int location) {
+  std::uint32_t hash = uniformId(name).hash;
+  std::size_t mask = uniformSlots.size() - 1;
+  std::size_t i = hash & mask;
+  while (uniformSlots[i].hash != 0) {
+    if (uniformSlots[i].hash == hash) {
+      std::cout << "ERROR::SHADER::UNIFORM_HASH_COLLISION: " << name << std::endl;
+      return;
+    }
+    i = (i + 1) & mask;
+  }
+  uniformSlots[i].hash = hash;
+  uniformSlots[i].location = location;
+}
+// ------------------------------------------------------------------------
+int Shader::uniformLocation(UniformId id) const {
+  if (uniformSlots.empty()) return -1;
+  std::size_t mask = uniformSlots.size() - 1;
+  for (std::size_t i = id.hash & mask; uniformSlots[i].hash != 0; i = (i + 1) & mask) {
+    if (uniformSlots[i].hash == id.hash) return uniformSlots[i].location;
+  }
+  return -1;
+}
+// ------------------------------------------------------------------------
+int Shader::uniformLocation(const std::string& name) const {
+  return uniformLocation(uniformId(name.c_str()));
+}
+// ------------------------------------------------------------------------
+void Shader::set(UniformId id, bool value) const { setBool(uniformLocation(id), value); }
+void Shader::set(UniformId id, int value) const { setInt(uniformLocation(id), value); }
+void Shader::set(UniformId id, float value) const { setFloat(uniformLocation(id), value); }
+void Shader::set(UniformId id, const glm::vec2& value) const {
+  setVec2(uniformLocation(id), value);
+}
+void Shader::set(UniformId id, const glm::vec3& value) const {
+  glUniform3f(uniformLocation(id), value.x, value.y, value.z);
+}
+void Shader::set(UniformId id, const glm::vec4& value) const {
+  glUniform4f(uniformLocation(id), value.x, value.y, value.z, value.w);
+}
+void Shader::set(UniformId id, const glm::mat4& mat) const { setMat4(uniformLocation(id), mat); }
 // utility uniform functions
 // ------------------------------------------------------------------------
 void Shader::setBool(const std::string& name, bool value) const {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+  setBool(uniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setInt(const std::string& name, int value) const {
-  glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+  setInt(uniformLocation(name), value);
 }
 // ------------------------------------------------------------------------
 void Shader::setFloat(const std::string& name, float value) const {
-  glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+  setFloat(uniformLocation(name), value);
 }
-
+// ------------------------------------------------------------------------
+void Shader::setVec2(const std::string& name, const glm::vec2& value) const {
+  setVec2(uniformLocation(name), value);
+}
+// ------------------------------------------------------------------------
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-  glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  setMat4(uniformLocation(name), mat);
+}
+// ------------------------------------------------------------------------
+void Shader::setBool(int location, bool value) const { glUniform1i(location, (int)value); }
+void Shader::setInt(int location, int value) const { glUniform1i(location, value); }
+void Shader::setFloat(int location, float value) const { glUniform1f(location, value); }
+void Shader::setVec2(int location, const glm::vec2& value) const {
+  glUniform2f(location, value.x, value.y);
+}
+void Shader::setMat4(int location, const glm::mat4& mat) const {
+  glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
 }
 
-void Shader::checkCompileErrors(unsigned int shader, std::string type) {
+bool Shader::checkCompileErrors(unsigned int shader, std::string type) {
   int success;
   char infoLog[1024];
   if (type != "PROGRAM") {
@@ -100,4 +372,5 @@ void Shader::checkCompileErrors(unsigned int shader, std::string type) {
                 << std::endl;
     }
   }
+  return success != 0;
 }
@@ -0,0 +1,38 @@
+#include "shader_source.h"
+
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+// ------------------------------------------------------------------------
+ShaderSource::ShaderSource() : code(""), length(0), ok(false) {}
+// ------------------------------------------------------------------------
+ShaderSource ShaderSource::fromFile(const char* path) {
+  ShaderSource source;
+  source.file = MappedFile(path);
+  if (!source.file.isOpen()) {
+    std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+    return source;
+  }
+  // the mapping doesn't move when the MappedFile does, so this pointer survives moves
+  if (source.file.size() > 0) source.code = (const char*)source.file.data();
+  source.length = source.file.size();
+  source.ok = true;
+  return source;
+}
+// ------------------------------------------------------------------------
+ShaderSource ShaderSource::fromMemory(const char* code) {
+  return fromMemory(code, std::strlen(code));
+}
+// ------------------------------------------------------------------------
+ShaderSource ShaderSource::fromMemory(const void* code, std::size_t size) {
+  ShaderSource source;
+  source.code = (const char*)code;
+  source.length = size;
+  source.ok = true;
+  return source;
+}
+// ------------------------------------------------------------------------
+bool ShaderSource::valid() const { return ok; }
+const char* ShaderSource::data() const { return code; }
+std::size_t ShaderSource::size() const { return length; }
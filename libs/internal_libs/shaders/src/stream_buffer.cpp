@@ -0,0 +1,129 @@
+#include "stream_buffer.h"
+#include "gl_ext.h"
+#include <glad/glad.h>
+
+#include <iostream>
+
+namespace {
+
+// more regions than this buy nothing: the CPU is never that far ahead of the GPU
+const unsigned int MAX_FRAMES = 8;
+// region starts suit any vertex or uniform alignment the GL asks for
+const std::size_t REGION_ALIGNMENT = 256;
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+StreamBuffer::StreamBuffer(std::size_t frameSize, unsigned int frames)
+    : ID(0),
+      regionSize((frameSize + REGION_ALIGNMENT - 1) & ~(REGION_ALIGNMENT - 1)),
+      regionCount(frames < 1 ? 1 : (frames > MAX_FRAMES ? MAX_FRAMES : frames)),
+      persistentMapping(glExtensions().bufferStorage),
+      persistentBase(nullptr),
+      region(0),
+      cursor(0),
+      mapped(nullptr),
+      mapStart(0),
+      stallCount(0) {
+  for (GLsync& fence : fences) fence = 0;
+  glGenBuffers(1, &ID);
+  // GL_COPY_WRITE_BUFFER leaves the array and element bindings of the current VAO alone
+  glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+  GLsizeiptr total = (GLsizeiptr)(regionSize * regionCount);
+  if (persistentMapping) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glExtensions().bufferStorageData(GL_COPY_WRITE_BUFFER, total, NULL, flags);
+    persistentBase = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags);
+    if (!persistentBase) std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+  } else {
+    glBufferData(GL_COPY_WRITE_BUFFER, total, NULL, GL_STREAM_DRAW);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  // the first beginFrame() moves to region 0
+  region = regionCount - 1;
+}
+// ------------------------------------------------------------------------
+bool StreamBuffer::persistent() const { return persistentMapping; }
+
+std::size_t StreamBuffer::frameSize() const { return regionSize; }
+
+unsigned long StreamBuffer::stalls() const { return stallCount; }
+// ------------------------------------------------------------------------
+void StreamBuffer::beginFrame() {
+  region = (region + 1) % regionCount;
+  cursor = 0;
+  GLsync& fence = fences[region];
+  if (!fence) return;
+  // polling first keeps the common case free of the flush a blocking wait implies
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+    stallCount++;
+    do {
+      status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // 1 ms
+    } while (status == GL_TIMEOUT_EXPIRED);
+  }
+  glDeleteSync(fence);
+  fence = 0;
+}
+// ------------------------------------------------------------------------
+StreamAllocation StreamBuffer::allocate(std::size_t bytes, std::size_t alignment) {
+  StreamAllocation allocation = {nullptr, 0, bytes};
+  if (alignment == 0) alignment = 1;
+  // aligned within the whole buffer, so offset / vertex size is a whole base vertex
+  std::size_t base = (std::size_t)region * regionSize;
+  std::size_t start = (base + cursor + alignment - 1) / alignment * alignment - base;
+  if (start + bytes > regionSize) return allocation;
+  if (persistentMapping) {
+    if (!persistentBase) return allocation;
+    allocation.data = persistentBase + base + start;
+  } else {
+    if (!mapped) {
+      // the rest of the region: the GPU is done with it (the fence said so), so there is
+      // nothing to sync with and nothing worth keeping
+      glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+      mapped = (unsigned char*)glMapBufferRange(
+          GL_COPY_WRITE_BUFFER, (GLintptr)(base + cursor), (GLsizeiptr)(regionSize - cursor),
+          GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+              GL_MAP_FLUSH_EXPLICIT_BIT);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+      if (!mapped) {
+        std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+        return allocation;
+      }
+      mapStart = cursor;
+    }
+    allocation.data = mapped + (start - mapStart);
+  }
+  allocation.offset = base + start;
+  cursor = start + bytes;
+  return allocation;
+}
+// ------------------------------------------------------------------------
+void StreamBuffer::flush() {
+  if (!mapped) return;
+  glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+  glFlushMappedBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)(cursor - mapStart));
+  if (glUnmapBuffer(GL_COPY_WRITE_BUFFER) == GL_FALSE) {
+    std::cout << "ERROR::STREAM_BUFFER::DATA_LOST" << std::endl;
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  mapped = nullptr;
+}
+// ------------------------------------------------------------------------
+void StreamBuffer::endFrame() {
+  flush();
+  if (fences[region]) glDeleteSync(fences[region]);
+  fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+// ------------------------------------------------------------------------
+void StreamBuffer::release() {
+  flush();
+  for (GLsync& fence : fences) {
+    if (fence) glDeleteSync(fence);
+    fence = 0;
+  }
+  // deleting a buffer unmaps it
+  glDeleteBuffers(1, &ID);
+  ID = 0;
+  persistentBase = nullptr;
+}
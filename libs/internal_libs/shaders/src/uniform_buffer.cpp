@@ -0,0 +1,70 @@
+#include "uniform_buffer.h"
+#include <glad/glad.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace {
+
+// binding point i belongs to blockNames[i]
+std::vector<std::string>& blockNames() {
+  static std::vector<std::string> names;
+  return names;
+}
+
+// glBindBufferRange offsets must be a multiple of this
+std::size_t uniformOffsetAlignment() {
+  static GLint alignment = 0;
+  if (alignment == 0) glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  return alignment > 0 ? (std::size_t)alignment : 256;
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+unsigned int uniformBlockBinding(const char* blockName) {
+  std::vector<std::string>& names = blockNames();
+  for (std::size_t i = 0; i < names.size(); i++) {
+    if (names[i] == blockName) return (unsigned int)i;
+  }
+  // GL 3.3 guarantees at least 36 binding points; more than a handful would be a leak
+  GLint maxBindings = 0;
+  glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &maxBindings);
+  if ((GLint)names.size() >= maxBindings) {
+    std::cout << "ERROR::UNIFORM_BUFFER::OUT_OF_BINDING_POINTS: " << blockName << std::endl;
+    return NO_UNIFORM_BLOCK_BINDING;
+  }
+  names.push_back(blockName);
+  return (unsigned int)(names.size() - 1);
+}
+// ------------------------------------------------------------------------
+UniformBuffer::UniformBuffer(const char* blockName, std::size_t size, unsigned int frames)
+    : binding(uniformBlockBinding(blockName)),
+      size(size),
+      // room for the copy wherever the GL's offset alignment puts it in a region
+      stream(size + uniformOffsetAlignment(), frames),
+      current(0) {
+  bind();
+}
+// ------------------------------------------------------------------------
+void UniformBuffer::update(const void* data, std::size_t bytes) {
+  if (bytes > size) bytes = size;
+  stream.beginFrame();
+  StreamAllocation block = stream.allocate(size, uniformOffsetAlignment());
+  if (block.data) {
+    std::memcpy(block.data, data, bytes);
+    current = block.offset;
+  }
+  stream.flush();
+  stream.endFrame();
+  bind();
+}
+// ------------------------------------------------------------------------
+void UniformBuffer::bind() const {
+  if (binding == NO_UNIFORM_BLOCK_BINDING) return;
+  glBindBufferRange(GL_UNIFORM_BUFFER, binding, stream.ID, (GLintptr)current, (GLsizeiptr)size);
+}
+// ------------------------------------------------------------------------
+void UniformBuffer::release() { stream.release(); }
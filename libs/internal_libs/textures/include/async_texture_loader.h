@@ -0,0 +1,156 @@
+#ifndef ASYNC_TEXTURE_LOADER_H
+#define ASYNC_TEXTURE_LOADER_H
+
+#include <glad/glad.h>
+
+#include "mip_chain.h"
+#include "pixel_upload_ring.h"
+#include "texture_cache.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// how a texture is sampled once it's uploaded
+struct TextureOptions {
+  bool flipVertically = true;
+  bool generateMipmaps = true;
+  // the colour is sRGB encoded: the texture is created GL_SRGB8(_ALPHA8), so sampling returns
+  // linear values, and the mips are averaged in linear light (RGB/RGBA images only)
+  bool srgb = false;
+  GLint wrap = GL_REPEAT;
+  GLint minFilter = GL_LINEAR_MIPMAP_LINEAR;
+  GLint magFilter = GL_LINEAR;
+  // upload the mips smallest first, spread over as many pump() calls as the time budget
+  // needs; meanwhile the texture samples the finest level that's in (GL_TEXTURE_BASE_LEVEL),
+  // so a big image shows up blurry within a frame instead of after its last level
+  bool streamLevels = true;
+  // leave out this many of the largest mip levels, so the texture is created at 1/2^n the
+  // size (and 1/4^n the memory); the image is decoded and cached in full either way
+  int skipLevels = 0;
+};
+
+// what an upload put on the GPU, see AsyncTextureLoader::recordUploads
+struct TextureUpload {
+  unsigned int texture;
+  bool failed;
+  int width;
+  int height;
+  int levelCount;
+  // driver-side size of all uploaded levels
+  std::size_t bytes;
+};
+
+// Decodes images with stb_image on a pool of worker threads. Finished images come back to the
+// GL thread through a lock-free list, and pump() uploads them a few at a time so a burst of
+// loads never stalls a frame for long.
+//
+// Everything except the workers runs on the GL thread. load() hands out the texture name
+// right away; until pump() uploads the decoded image it samples as a transparent 1x1 texel.
+// With TextureOptions::streamLevels (the default) pump() uploads a level at a time, smallest
+// first and round robin between textures, so every pending texture gets a coarse version
+// before any gets its finest level.
+//
+// Workers also build the mip chain (see generateMipChain, so the GL thread never runs
+// glGenerateMipmap) and store the result in a TextureCacheFile keyed by the
+// encoded bytes and the options that change the pixels, so later runs map the cache entry and
+// upload straight from it without decoding. Fresh images are copied into a free slot of a
+// PixelUploadRing, making the upload a DMA from the pixel buffer; images larger than a slot,
+// or decoded while every slot is busy, are uploaded from client memory instead.
+class AsyncTextureLoader {
+ public:
+  // 0 workers means one per hardware thread, minus one for the GL thread; 0 staging slots
+  // uploads everything from client memory
+  explicit AsyncTextureLoader(unsigned int workerCount = 0, unsigned int stagingSlots = 4,
+                              std::size_t stagingSlotSize = 8 << 20);
+  // waits for the workers to finish their current image; textures stay alive
+  ~AsyncTextureLoader();
+  AsyncTextureLoader(const AsyncTextureLoader &) = delete;
+  AsyncTextureLoader &operator=(const AsyncTextureLoader &) = delete;
+
+  // encoded image in memory (e.g. an embedded asset); must stay valid until it's uploaded
+  unsigned int load(const void *data, std::size_t size, const TextureOptions &options = {});
+  // image file, read by the worker; a texcook container file is uploaded as it is
+  unsigned int load(const std::string &path, const TextureOptions &options = {});
+  // texture cooked by texcook, uploaded compressed if this GL has the block format and
+  // otherwise decoded from `source` like load(); both must stay valid until the upload.
+  // The container already has its mips and flip, so only the sampling options apply.
+  unsigned int loadCooked(const void *cooked, std::size_t cookedSize, const void *source,
+                          std::size_t sourceSize, const TextureOptions &options = {});
+
+  // upload decoded images until budgetMs has passed (at least one level if any are ready);
+  // returns how many textures were completed
+  int pump(double budgetMs);
+  // upload everything requested so far, waiting for the workers as needed
+  void finish();
+  // requested but not uploaded yet
+  std::size_t pending() const;
+  // keep a TextureUpload for every upload (or failed decode) until takeUploads() collects it;
+  // off by default so apps that never ask don't pile them up
+  void recordUploads(bool enabled);
+  std::vector<TextureUpload> takeUploads();
+  // where decoded textures are kept between runs (<build>/cache/textures unless set); an
+  // empty path disables the cache. Set it before the first load, the workers read it.
+  static void setCacheDirectory(const std::string &directory);
+  // finishes outstanding uploads and deletes the staging buffers; call before the context
+  // goes away (later loads upload from client memory)
+  void deleteStagingBuffers();
+
+ private:
+  struct Job {
+    unsigned int texture;
+    TextureOptions options;
+    const void *data;
+    std::size_t size;
+    std::string path;
+    // filled in by the worker: the levels are in the cache entry (or cooked container), in a
+    // staging slot or in `image`, checked in that order
+    TextureCacheFile cached;
+    int slot;
+    std::vector<unsigned char> image;
+    std::vector<MipLevel> levels;
+    int channels;
+    std::string error;
+    // GL thread: levels uploaded so far, counting from the smallest, and their size
+    std::size_t uploadedLevels;
+    std::size_t uploadedBytes;
+    Job *next;
+  };
+
+  std::vector<std::thread> workers;
+  // requests for the workers
+  std::mutex queueMutex;
+  std::condition_variable queueReady;
+  std::deque<Job *> queue;
+  bool stopping;
+  // decoded images, pushed by workers and taken all at once by the GL thread (a Treiber stack)
+  std::atomic<Job *> decoded;
+  // GL thread only: taken from `decoded` but not uploaded yet, oldest first
+  std::deque<Job *> ready;
+  std::size_t outstanding;
+  std::unique_ptr<PixelUploadRing> staging;
+  bool recording;
+  std::vector<TextureUpload> uploads;
+
+  static std::string cacheDirectory;
+
+  unsigned int submit(Job *job);
+  void workerLoop();
+  void decode(Job &job);
+  void collectDecoded();
+  // uploads the next level (or all of them without streaming); true once it's complete
+  bool upload(Job &job);
+  void recordUpload(const Job &job, bool failed);
+  static bool compressedFormatSupported(std::uint32_t format);
+  static std::size_t bytesPerTexel(int channels);
+  static std::uint64_t cacheKey(const void *source, std::size_t size,
+                                const TextureOptions &options);
+};
+#endif
@@ -0,0 +1,30 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU encoders for the BCn block formats, used by texcook to cook textures offline. Every
+// format stores a 4x4 pixel block in a fixed number of bytes:
+//   BC1  8 bytes, RGB with two 5:6:5 endpoints and 2-bit indices (6:1 against RGB8)
+//   BC3 16 bytes, BC1 colour plus a separate 8-bit alpha ramp with 3-bit indices (4:1)
+//   BC7 16 bytes, here always mode 6: RGBA 7.7.7.7+p endpoints and 4-bit indices (4:1)
+// Endpoints come from the block's principal axis, indices from the nearest palette entry.
+enum class BlockFormat { BC1, BC3, BC7 };
+
+// GL internal format for glCompressedTexImage2D
+std::uint32_t blockFormatGL(BlockFormat format);
+// bytes per 4x4 block of a GL compressed format, or 0 for formats we don't know
+std::size_t compressedBlockBytes(std::uint32_t glFormat);
+// bytes of one width x height level; partial blocks at the edges still take a whole block
+std::size_t compressedLevelSize(std::uint32_t glFormat, int width, int height);
+
+// `rgba` is 16 pixels of 4 bytes, row by row
+void compressBlockBC1(const unsigned char *rgba, unsigned char *out);
+void compressBlockBC3(const unsigned char *rgba, unsigned char *out);
+void compressBlockBC7(const unsigned char *rgba, unsigned char *out);
+
+// whole RGBA8 image into compressedLevelSize(blockFormatGL(format), width, height) bytes
+void compressImage(BlockFormat format, const unsigned char *rgba, int width, int height,
+                   unsigned char *out);
+#endif
@@ -0,0 +1,23 @@
+#ifndef IMAGE_RGBA_H
+#define IMAGE_RGBA_H
+
+#include <cstddef>
+#include <vector>
+
+// A decoded 8-bit RGBA image in CPU memory, rows bottom to top once flipped for GL
+struct ImageRGBA {
+  int width = 0;
+  int height = 0;
+  std::vector<unsigned char> pixels;
+};
+
+// Decodes an encoded image (anything stb_image reads) to RGBA whatever its channel count.
+// Safe on any thread; prints ERROR::TEXTURE::DECODE_FAILED and returns false on failure.
+bool decodeImageRGBA(const void *data, std::size_t size, bool flipVertically, ImageRGBA &image);
+
+// Copies a width x height RGBA image into `dst` at (x, y) and repeats its edge pixels over
+// `padding` more texels on every side (clipped to `dst`), so filtering at the border of the
+// copy reads the image's own colours rather than whatever is next to it.
+void blitPadded(unsigned char *dst, int dstWidth, int dstHeight, int x, int y,
+                const unsigned char *src, int width, int height, int padding);
+#endif
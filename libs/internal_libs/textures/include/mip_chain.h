@@ -0,0 +1,29 @@
+#ifndef MIP_CHAIN_H
+#define MIP_CHAIN_H
+
+#include <cstddef>
+#include <vector>
+
+// One level of a tightly packed 8-bit image with all its mips stored back to back
+struct MipLevel {
+  int width;
+  int height;
+  std::size_t offset;  // from the start of level 0
+  std::size_t size;
+};
+
+// Level sizes and offsets for a width x height image; just level 0 unless `mipmapped`,
+// otherwise every level down to 1x1 as glGenerateMipmap would make them.
+std::vector<MipLevel> mipLayout(int width, int height, int channels, bool mipmapped);
+// bytes needed for all of `levels`
+std::size_t mipChainSize(const std::vector<MipLevel> &levels);
+
+// Fill levels 1.. of `image` (laid out by mipLayout) from level 0 with a 2x2 box filter.
+// Sizes halve rounding down, so an odd last row/column is dropped; a dimension that is
+// already 1 pairs with itself. With `srgb` the colour channels of RGB/RGBA images are
+// averaged in linear light, so mips of sRGB textures don't darken; alpha is always linear.
+// Runs on the loader's worker threads: SSE2 where the target has it (every x86-64), plain
+// C++ otherwise.
+void generateMipChain(unsigned char *image, const std::vector<MipLevel> &levels, int channels,
+                      bool srgb = false);
+#endif
@@ -0,0 +1,63 @@
+#ifndef PIXEL_UPLOAD_RING_H
+#define PIXEL_UPLOAD_RING_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+// A ring of mapped pixel unpack buffers for streaming texture data. A worker thread fills a
+// slot through its mapped pointer; the GL thread then sources glTexImage* from it, so the
+// driver can DMA the pixels instead of copying them out of client memory during the call.
+// A fence per upload tells when the GPU is done and the slot can be handed out again.
+//
+// With buffer storage (GL 4.4 / ARB_buffer_storage) all slots live in one buffer that stays
+// persistently mapped. Without it every slot is its own buffer, mapped with
+// glMapBufferRange while it's free and unmapped just before its upload.
+class PixelUploadRing {
+ public:
+  // GL thread
+  PixelUploadRing(unsigned int slotCount, std::size_t slotSize);
+  PixelUploadRing(const PixelUploadRing &) = delete;
+  PixelUploadRing &operator=(const PixelUploadRing &) = delete;
+
+  bool persistent() const;
+  std::size_t slotSize() const;
+
+  // any thread: a free slot that can take `bytes`, or -1 if none is free (or it's too big)
+  int acquire(std::size_t bytes);
+  // any thread: where to write the data for an acquired slot
+  unsigned char *data(int slot) const;
+
+  // GL thread: binds the slot as GL_PIXEL_UNPACK_BUFFER and returns the "pointer" to pass as
+  // the pixels argument of glTexImage*/glTexSubImage*. A slot can be uploaded from in several
+  // goes (e.g. one mip level per frame), each between beginUpload and endUpload.
+  const void *beginUpload(int slot);
+  // GL thread: unbinds; after the `last` go also fences the slot's uploads so recycle() can
+  // hand it out again once the GPU is done
+  void endUpload(int slot, bool last = true);
+  // GL thread: hands slots whose uploads have finished back to acquire(); never blocks
+  void recycle();
+  // GL thread: deletes the buffers; every slot must be free or uploaded by now
+  void release();
+
+ private:
+  enum class State { Free, Writing, Uploading };
+  struct Slot {
+    unsigned int buffer;
+    std::size_t offset;
+    unsigned char *mapped;
+    GLsync fence;
+    State state;
+  };
+
+  std::vector<Slot> slots;
+  std::size_t size;
+  bool persistentMapping;
+  // guards slot state between workers (acquire) and the GL thread
+  std::mutex mutex;
+
+  void map(Slot &slot);
+};
+#endif
@@ -0,0 +1,40 @@
+#ifndef SKYLINE_PACKER_H
+#define SKYLINE_PACKER_H
+
+#include <cstddef>
+#include <vector>
+
+// Packs rectangles into a fixed-size bin with the skyline bottom-left heuristic: the bin's
+// used area is kept as a list of horizontal segments (its "skyline"), and every rectangle
+// goes where its top ends lowest, ties going to the spot that wastes the least width. It is
+// fast and packs sprite sets close to maxrects, but never fills holes under the skyline, so
+// inserting tall rectangles first gives the best results.
+class SkylinePacker {
+ public:
+  SkylinePacker(int width, int height);
+
+  // finds room for a width x height rectangle; false if it doesn't fit anywhere
+  bool insert(int width, int height, int &x, int &y);
+  // empties the bin
+  void reset();
+
+  int width() const;
+  int height() const;
+  // fraction of the bin covered by inserted rectangles
+  float occupancy() const;
+
+ private:
+  struct Segment {
+    int x;
+    int y;
+    int width;
+  };
+  int binWidth;
+  int binHeight;
+  long long usedArea;
+  std::vector<Segment> skyline;
+
+  // the y a rectangle starting at segment `index` would sit at, or -1 if it doesn't fit there
+  int fitAt(std::size_t index, int width, int height) const;
+};
+#endif
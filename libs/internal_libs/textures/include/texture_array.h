@@ -0,0 +1,44 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include "async_texture_loader.h"
+#include "texture_region.h"
+
+#include <cstddef>
+#include <vector>
+
+// A GL_TEXTURE_2D_ARRAY with one image per layer, for sprite sets whose images are too big
+// (or too many) for an atlas. Unlike an atlas every layer keeps its full mip chain, and an
+// image that fills its layer can wrap. All layers share one size; a smaller image is stored
+// in the corner of its layer, with its edges repeated over the rest, and its region maps
+// 0..1 onto just that corner. Shaders sample it with a sampler2DArray and vec3(u, v, layer).
+class TextureArray {
+ public:
+  unsigned int ID;
+
+  // GL thread: allocates every layer and level up front
+  TextureArray(int width, int height, int layers, const TextureOptions &options = {});
+  TextureArray(const TextureArray &) = delete;
+  TextureArray &operator=(const TextureArray &) = delete;
+
+  // GL thread: uploads an RGBA image into the next free layer; returns the layer, or -1 if
+  // the array is full or the image is bigger than a layer
+  int add(const unsigned char *rgba, int width, int height);
+  // decodes an encoded image (see decodeImageRGBA) and adds it
+  int addEncoded(const void *data, std::size_t size, bool flipVertically = true);
+
+  const TextureRegion &region(int layer) const;
+  int layerCount() const;
+  int usedLayers() const;
+
+  // GL thread: deletes the texture
+  void release();
+
+ private:
+  int layerWidth;
+  int layerHeight;
+  int layers;
+  TextureOptions options;
+  std::vector<TextureRegion> regions;
+};
+#endif
@@ -0,0 +1,50 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include "async_texture_loader.h"
+#include "skyline_packer.h"
+#include "texture_region.h"
+
+#include <cstddef>
+#include <vector>
+
+// Packs many small RGBA images into one GL_TEXTURE_2D so sprites that use different images
+// can share a bind (and a draw call). Images are placed with a SkylinePacker in CPU memory;
+// upload() then creates or refreshes the texture, and region() says where each image went.
+//
+// Every image is surrounded by `padding` texels that repeat its edges, so bilinear filtering
+// never pulls in a neighbour. Each mip level halves the padding, so upload() only builds the
+// levels that still have a texel of it: 1 + log2(padding) of them.
+class TextureAtlas {
+ public:
+  unsigned int ID;
+
+  TextureAtlas(int width, int height, int padding = 2);
+  TextureAtlas(const TextureAtlas &) = delete;
+  TextureAtlas &operator=(const TextureAtlas &) = delete;
+
+  // copies a width x height RGBA image in; returns its region index, or -1 if it's full
+  int add(const unsigned char *rgba, int width, int height);
+  // decodes an encoded image (see decodeImageRGBA) and adds it
+  int addEncoded(const void *data, std::size_t size, bool flipVertically = true);
+
+  const TextureRegion &region(int index) const;
+  std::size_t regionCount() const;
+  float occupancy() const;
+
+  // GL thread: creates the texture on the first call (ID is 0 until then) and re-uploads it
+  // after more adds; wrap is always clamp, repeating would show the neighbouring images
+  unsigned int upload(const TextureOptions &options = {});
+
+  // GL thread: deletes the texture
+  void release();
+
+ private:
+  int atlasWidth;
+  int atlasHeight;
+  int padding;
+  SkylinePacker packer;
+  std::vector<unsigned char> pixels;
+  std::vector<TextureRegion> regions;
+};
+#endif
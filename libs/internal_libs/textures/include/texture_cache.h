@@ -0,0 +1,57 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <mapped_file.h>
+
+#include "mip_chain.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A decoded, mipmapped texture on disk. The file is a fixed header, a table of levels and
+// then the levels' pixels exactly as glTexImage2D (or glCompressedTexImage2D) takes them, so
+// a cache hit is a mapping that gets uploaded in place: no decode, no mip generation, no copy.
+// texcook writes block-compressed textures in the same container.
+//
+//   TextureCacheHeader | TextureCacheLevel[levelCount] | padding | level 0 | level 1 | ...
+class TextureCacheFile {
+ public:
+  TextureCacheFile();
+  // maps the cache entry for `key`; valid() is false if there is none or it doesn't check out
+  TextureCacheFile(const std::string &directory, std::uint64_t key);
+  // maps a container file of any key, e.g. a cooked texture
+  static TextureCacheFile open(const std::string &path);
+  // reads a container that is already in memory, which must outlive the result
+  static TextureCacheFile fromMemory(const void *data, std::size_t size);
+  // whether the bytes start like a container (the rest is checked when it's read)
+  static bool isContainer(const void *data, std::size_t size);
+
+  bool valid() const;
+  int width() const;
+  int height() const;
+  int channels() const;
+  // GL compressed internal format, or 0 for plain 8-bit pixels of channels() components
+  std::uint32_t format() const;
+  const std::vector<MipLevel> &levels() const;
+  // start of level 0; MipLevel offsets are relative to this
+  const unsigned char *data() const;
+
+  // writes an entry; the file appears atomically, so concurrent readers never see half of it
+  static bool store(const std::string &directory, std::uint64_t key, int channels,
+                    const std::vector<MipLevel> &levels, const unsigned char *data);
+  // the same for any path and format; `levels` sizes must match the format
+  static bool write(const std::string &path, std::uint64_t key, std::uint32_t format,
+                    int channels, const std::vector<MipLevel> &levels, const unsigned char *data);
+
+ private:
+  MappedFile file;
+  std::vector<MipLevel> mipLevels;
+  int imageChannels;
+  std::uint32_t imageFormat;
+  const unsigned char *pixels;
+
+  void parse(const unsigned char *bytes, std::size_t size, const std::uint64_t *expectedKey);
+};
+#endif
@@ -0,0 +1,91 @@
+#ifndef TEXTURE_MANAGER_H
+#define TEXTURE_MANAGER_H
+
+#include "async_texture_loader.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Owns a set of textures loaded through an AsyncTextureLoader and keeps the memory they take
+// on the GPU (every uploaded level, at its internal format's size) under a budget.
+//
+// Textures are registered up front but only loaded the first time use() asks for them. Once
+// per frame update() accounts for finished uploads; while the total is over budget it takes
+// the least recently used texture and reloads it one mip level smaller (a quarter of the
+// memory), or deletes it outright once it's down to its last level or hasn't been used for
+// `unloadAfterFrames`. Textures used in the current frame are never touched. A texture that
+// was shrunk or deleted comes back at full size through the loader when it's used again and
+// the budget has room; until the new upload lands, use() keeps returning the old texture.
+// A texture's first load is returned while it streams in, so nothing waits for its full
+// mip chain.
+//
+// Reloads decode nothing when the loader's disk cache is on: they map the cached mip chain.
+class TextureManager {
+ public:
+  typedef int Handle;
+
+  // GL thread; the loader must outlive the manager. It records uploads from now on.
+  TextureManager(AsyncTextureLoader &loader, std::size_t budgetBytes);
+  TextureManager(const TextureManager &) = delete;
+  TextureManager &operator=(const TextureManager &) = delete;
+
+  // the same sources AsyncTextureLoader takes; memory must stay valid while the manager lives
+  Handle add(const void *data, std::size_t size, const TextureOptions &options = {});
+  Handle add(const std::string &path, const TextureOptions &options = {});
+  Handle addCooked(const void *cooked, std::size_t cookedSize, const void *source,
+                   std::size_t sourceSize, const TextureOptions &options = {});
+
+  // the texture to bind for `handle` this frame; marks it used. During the first load that's
+  // the texture being streamed in, showing whichever levels have landed; 0 before the load
+  // starts and for good if it fails.
+  unsigned int use(Handle handle);
+  // once per frame, after the loader's pump()
+  void update();
+
+  std::size_t budget() const;
+  void setBudget(std::size_t bytes);
+  std::size_t residentBytes() const;
+  // mip levels `handle` is currently missing (0 at full size, -1 when not loaded at all)
+  int droppedLevels(Handle handle) const;
+  // frames a texture may go unused before it's deleted instead of shrunk
+  void setUnloadAfterFrames(std::uint64_t frames);
+
+  // GL thread: deletes every texture; call before the context goes away
+  void release();
+
+ private:
+  struct Entry {
+    const void *data;
+    std::size_t size;
+    const void *cooked;
+    std::size_t cookedSize;
+    std::string path;
+    TextureOptions options;
+    unsigned int texture;
+    std::size_t bytes;
+    int skipLevels;
+    int levelCount;  // of the full chain, known after the first upload
+    // a load in flight and how many levels it skips
+    unsigned int pending;
+    int pendingSkip;
+    // a load of it failed: it's never requested again
+    bool failed;
+    std::uint64_t lastUsed;
+  };
+
+  AsyncTextureLoader &loader;
+  std::vector<Entry> entries;
+  std::size_t budgetBytes;
+  std::size_t resident;
+  std::uint64_t frame;
+  std::uint64_t unloadAfter;
+
+  Handle addEntry(const Entry &entry);
+  void request(Entry &entry, int skipLevels);
+  void finishUpload(const TextureUpload &upload);
+  void enforceBudget();
+  void unload(Entry &entry);
+};
+#endif
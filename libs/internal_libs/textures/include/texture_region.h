@@ -0,0 +1,17 @@
+#ifndef TEXTURE_REGION_H
+#define TEXTURE_REGION_H
+
+// Where one image lives inside a shared texture: a layer (always 0 in an atlas) and the
+// rectangle of texture coordinates it covers. Quads written for a whole texture, with
+// coordinates in 0..1, are pointed at the image by remapping them through the region.
+struct TextureRegion {
+  int layer = 0;
+  float u0 = 0.0f;
+  float v0 = 0.0f;
+  float u1 = 1.0f;
+  float v1 = 1.0f;
+
+  float u(float s) const { return u0 + s * (u1 - u0); }
+  float v(float t) const { return v0 + t * (v1 - v0); }
+};
+#endif
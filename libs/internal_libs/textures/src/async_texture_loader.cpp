@@ -0,0 +1,374 @@
+#include "async_texture_loader.h"
+#include <fnv1a.h>
+#include <gl_ext.h>
+#include <gl_state.h>
+#include <mapped_file.h>
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// in the build tree by default (see CMakeLists.txt), so it doesn't follow the working directory
+#ifndef TEXTURE_CACHE_DIR
+#define TEXTURE_CACHE_DIR "texture_cache"
+#endif
+std::string AsyncTextureLoader::cacheDirectory = TEXTURE_CACHE_DIR;
+
+// ------------------------------------------------------------------------
+AsyncTextureLoader::AsyncTextureLoader(unsigned int workerCount, unsigned int stagingSlots,
+                                       std::size_t stagingSlotSize)
+    : stopping(false), decoded(nullptr), outstanding(0), recording(false) {
+  if (stagingSlots > 0) staging.reset(new PixelUploadRing(stagingSlots, stagingSlotSize));
+  if (workerCount == 0) {
+    unsigned int hardware = std::thread::hardware_concurrency();
+    workerCount = hardware > 1 ? hardware - 1 : 1;
+  }
+  for (unsigned int i = 0; i < workerCount; i++) {
+    workers.emplace_back(&AsyncTextureLoader::workerLoop, this);
+  }
+}
+// ------------------------------------------------------------------------
+AsyncTextureLoader::~AsyncTextureLoader() {
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    stopping = true;
+  }
+  queueReady.notify_all();
+  for (std::thread& worker : workers) worker.join();
+
+  // whatever never made it to the GPU
+  collectDecoded();
+  for (Job* job : queue) ready.push_back(job);
+  for (Job* job : ready) delete job;
+}
+// ------------------------------------------------------------------------
+unsigned int AsyncTextureLoader::load(const void* data, std::size_t size,
+                                      const TextureOptions& options) {
+  Job* job = new Job();
+  job->options = options;
+  job->data = data;
+  job->size = size;
+  return submit(job);
+}
+unsigned int AsyncTextureLoader::load(const std::string& path, const TextureOptions& options) {
+  Job* job = new Job();
+  job->options = options;
+  job->data = nullptr;
+  job->size = 0;
+  job->path = path;
+  return submit(job);
+}
+// ------------------------------------------------------------------------
+unsigned int AsyncTextureLoader::loadCooked(const void* cooked, std::size_t cookedSize,
+                                            const void* source, std::size_t sourceSize,
+                                            const TextureOptions& options) {
+  // only the header is read here; the worker checks the rest like any other container
+  TextureCacheFile container = TextureCacheFile::fromMemory(cooked, cookedSize);
+  if (container.valid() && compressedFormatSupported(container.format())) {
+    return load(cooked, cookedSize, options);
+  }
+  return load(source, sourceSize, options);
+}
+// create the texture with a placeholder now so the caller can bind it straight away
+// ------------------------------------------------------------------------
+unsigned int AsyncTextureLoader::submit(Job* job) {
+  glGenTextures(1, &job->texture);
+  glState().bindTexture(GL_TEXTURE_2D, job->texture);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, job->options.wrap);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, job->options.wrap);
+  // no mipmaps yet, so a mipmapped min filter would leave the placeholder incomplete
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, job->options.magFilter);
+  const unsigned char placeholder[4] = {0, 0, 0, 0};
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+  job->slot = -1;
+  job->channels = 0;
+  job->uploadedLevels = 0;
+  job->uploadedBytes = 0;
+  job->next = nullptr;
+  outstanding++;
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    queue.push_back(job);
+  }
+  queueReady.notify_one();
+  return job->texture;
+}
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::workerLoop() {
+  for (;;) {
+    Job* job;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueReady.wait(lock, [this] { return stopping || !queue.empty(); });
+      if (stopping) return;
+      job = queue.front();
+      queue.pop_front();
+    }
+    decode(*job);
+    // push onto the decoded list; the GL thread takes the whole list in one exchange
+    Job* head = decoded.load(std::memory_order_relaxed);
+    do {
+      job->next = head;
+    } while (!decoded.compare_exchange_weak(head, job, std::memory_order_release,
+                                            std::memory_order_relaxed));
+  }
+}
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::decode(Job& job) {
+  // files are mapped rather than handed to stbi_load so their bytes can be hashed too
+  MappedFile file;
+  const void* source = job.data;
+  std::size_t size = job.size;
+  if (!source) {
+    file = MappedFile(job.path);
+    if (!file.isOpen()) {
+      job.error = "can't open file";
+      return;
+    }
+    source = file.data();
+    size = file.size();
+  }
+
+  // 0. cooked by texcook: the levels are ready to upload as they are
+  if (TextureCacheFile::isContainer(source, size)) {
+    TextureCacheFile container = file.isOpen() ? TextureCacheFile::open(job.path)
+                                               : TextureCacheFile::fromMemory(source, size);
+    if (!container.valid()) {
+      job.error = "corrupt texture container";
+      return;
+    }
+    job.levels = container.levels();
+    job.channels = container.channels();
+    job.cached = std::move(container);
+    return;
+  }
+
+  // 1. a previous run already did all the work
+  std::uint64_t key = 0;
+  if (!cacheDirectory.empty()) {
+    key = cacheKey(source, size, job.options);
+    TextureCacheFile cached(cacheDirectory, key);
+    if (cached.valid()) {
+      job.levels = cached.levels();
+      job.channels = cached.channels();
+      job.cached = std::move(cached);
+      return;
+    }
+  }
+
+  // 2. decode; the global flip flag would race between workers, this one is per thread
+  stbi_set_flip_vertically_on_load_thread(job.options.flipVertically);
+  int width = 0, height = 0;
+  unsigned char* pixels = stbi_load_from_memory((const stbi_uc*)source, (int)size, &width,
+                                                &height, &job.channels, 0);
+  if (!pixels) {
+    job.error = stbi_failure_reason() ? stbi_failure_reason() : "unknown error";
+    return;
+  }
+  job.levels = mipLayout(width, height, job.channels, job.options.generateMipmaps);
+  job.image.resize(mipChainSize(job.levels));
+  std::memcpy(job.image.data(), pixels, job.levels[0].size);
+  stbi_image_free(pixels);
+  generateMipChain(job.image.data(), job.levels, job.channels, job.options.srgb);
+  if (!cacheDirectory.empty()) {
+    TextureCacheFile::store(cacheDirectory, key, job.channels, job.levels, job.image.data());
+  }
+
+  // 3. stage it; the mapping is write-only, which is why the mips are built in `image` first
+  int slot = staging ? staging->acquire(job.image.size()) : -1;
+  if (slot < 0) return;
+  std::memcpy(staging->data(slot), job.image.data(), job.image.size());
+  std::vector<unsigned char>().swap(job.image);
+  job.slot = slot;
+}
+// S3TC is an extension even on GL 4.6 (it's patent-encumbered), BPTC is core since 4.2
+// ------------------------------------------------------------------------
+bool AsyncTextureLoader::compressedFormatSupported(std::uint32_t format) {
+  switch (format) {
+    case 0:
+      return true;
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+      return glExtensions().textureCompressionS3TC;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+      return glExtensions().textureCompressionBPTC;
+    default:
+      return false;
+  }
+}
+// the decoded pixels only depend on the encoded bytes and the options that change them
+// ------------------------------------------------------------------------
+std::uint64_t AsyncTextureLoader::cacheKey(const void* source, std::size_t size,
+                                           const TextureOptions& options) {
+  std::uint64_t key = fnv1a64Bytes(source, size);
+  const unsigned char flags[3] = {(unsigned char)options.flipVertically,
+                                  (unsigned char)options.generateMipmaps,
+                                  (unsigned char)options.srgb};
+  return fnv1a64Bytes(flags, sizeof(flags), key);
+}
+// move decoded jobs into `ready`; the list comes off the stack newest first
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::collectDecoded() {
+  Job* job = decoded.exchange(nullptr, std::memory_order_acquire);
+  std::size_t end = ready.size();
+  for (; job; job = job->next) ready.insert(ready.begin() + end, job);
+}
+// ------------------------------------------------------------------------
+int AsyncTextureLoader::pump(double budgetMs) {
+  if (staging) staging->recycle();
+  collectDecoded();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  int completed = 0;
+  bool uploaded = false;
+  while (!ready.empty()) {
+    if (uploaded) {
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      if (elapsed.count() >= budgetMs) break;
+    }
+    Job* job = ready.front();
+    ready.pop_front();
+    uploaded = true;
+    if (!upload(*job)) {
+      // round robin: the other textures get their next level before this one does
+      ready.push_back(job);
+      continue;
+    }
+    delete job;
+    outstanding--;
+    completed++;
+  }
+  return completed;
+}
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::finish() {
+  while (outstanding > 0) {
+    if (pump(1e9) == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+// ------------------------------------------------------------------------
+std::size_t AsyncTextureLoader::pending() const { return outstanding; }
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::recordUploads(bool enabled) {
+  recording = enabled;
+  if (!enabled) uploads.clear();
+}
+// ------------------------------------------------------------------------
+std::vector<TextureUpload> AsyncTextureLoader::takeUploads() {
+  std::vector<TextureUpload> taken;
+  taken.swap(uploads);
+  return taken;
+}
+// drivers store 3-channel textures padded to 4 bytes a texel
+// ------------------------------------------------------------------------
+std::size_t AsyncTextureLoader::bytesPerTexel(int channels) { return channels == 3 ? 4 : channels; }
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::setCacheDirectory(const std::string& directory) {
+  cacheDirectory = directory;
+}
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::deleteStagingBuffers() {
+  finish();
+  if (!staging) return;
+  // workers check `staging` without a lock, and none can be mid-decode with nothing pending
+  staging->release();
+  staging.reset();
+}
+// ------------------------------------------------------------------------
+void AsyncTextureLoader::recordUpload(const Job& job, bool failed) {
+  if (!recording) return;
+  TextureUpload upload = {job.texture, failed, 0, 0, 0, job.uploadedBytes};
+  if (!failed) {
+    std::size_t first = job.levels.size() - job.uploadedLevels;
+    upload.width = job.levels[first].width;
+    upload.height = job.levels[first].height;
+    upload.levelCount = (int)job.uploadedLevels;
+  }
+  uploads.push_back(upload);
+}
+// ------------------------------------------------------------------------
+bool AsyncTextureLoader::upload(Job& job) {
+  if (!job.error.empty()) {
+    std::cout << "ERROR::TEXTURE::DECODE_FAILED: "
+              << (job.path.empty() ? std::string("image in memory") : job.path) << ": "
+              << job.error << std::endl;
+    recordUpload(job, true);
+    return true;
+  }
+  std::uint32_t compressed = job.cached.valid() ? job.cached.format() : 0;
+  if (!compressedFormatSupported(compressed)) {
+    std::cout << "ERROR::TEXTURE::FORMAT_NOT_SUPPORTED: "
+              << (job.path.empty() ? std::string("image in memory") : job.path) << ": 0x"
+              << std::hex << compressed << std::dec << std::endl;
+    recordUpload(job, true);
+    return true;
+  }
+  GLenum format = GL_RGB;
+  if (job.channels == 4) {
+    format = GL_RGBA;
+  } else if (job.channels == 2) {
+    format = GL_RG;
+  } else if (job.channels == 1) {
+    format = GL_RED;
+  }
+  GLint internalFormat = format;
+  if (job.options.srgb && job.channels == 4) {
+    internalFormat = GL_SRGB8_ALPHA8;
+  } else if (job.options.srgb && job.channels == 3) {
+    internalFormat = GL_SRGB8;
+  }
+  // skipped levels stay in the chain, level `first` just becomes level 0
+  std::size_t first = std::min((std::size_t)std::max(job.options.skipLevels, 0),
+                               job.levels.size() - 1);
+  std::size_t last = job.levels.size() - 1;
+
+  glState().bindTexture(GL_TEXTURE_2D, job.texture);
+  // rows of RGB images aren't 4 byte aligned unless the width happens to work out
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  const unsigned char* base;
+  if (job.cached.valid()) {
+    // straight from the mapped cache file
+    base = job.cached.data();
+  } else if (job.slot >= 0) {
+    // from the pixel buffer: returns without touching the pixels, the GPU pulls them later
+    base = (const unsigned char*)staging->beginUpload(job.slot);
+  } else {
+    base = job.image.data();
+  }
+  // smallest first; one level per call when streaming, the whole chain otherwise
+  std::size_t level = last - job.uploadedLevels;
+  for (;;) {
+    const MipLevel& mip = job.levels[level];
+    GLint target = (GLint)(level - first);
+    if (compressed != 0) {
+      // the driver copies the blocks as they are: a quarter to a sixth of the bytes, no decode
+      glCompressedTexImage2D(GL_TEXTURE_2D, target, compressed, mip.width, mip.height, 0,
+                             (GLsizei)mip.size, base + mip.offset);
+      job.uploadedBytes += mip.size;
+    } else {
+      glTexImage2D(GL_TEXTURE_2D, target, internalFormat, mip.width, mip.height, 0, format,
+                   GL_UNSIGNED_BYTE, base + mip.offset);
+      job.uploadedBytes += (std::size_t)mip.width * mip.height * bytesPerTexel(job.channels);
+    }
+    job.uploadedLevels++;
+    if (level == first || job.options.streamLevels) break;
+    level--;
+  }
+  bool complete = level == first;
+  if (!job.cached.valid() && job.slot >= 0) staging->endUpload(job.slot, complete);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+  // sample only the levels that are in; the placeholder's 1x1 level 0 is below the base
+  // until the real one replaces it. The mips came with the image, so without streaming a
+  // mipmapped filter still finds the chain complete.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)(level - first));
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)(last - first));
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, job.options.minFilter);
+  if (complete) recordUpload(job, false);
+  return complete;
+}
@@ -0,0 +1,332 @@
+#include "block_compression.h"
+#include <gl_ext.h>
+
+#include <cstring>
+
+namespace {
+
+// Endpoints along the principal axis of the block's colours (the first `channels` of each
+// pixel), found by power iteration on the covariance matrix. Falls back to the block's
+// bounding box diagonal when the block is (nearly) a single colour.
+void principalEndpoints(const unsigned char* rgba, int channels, float* low, float* high) {
+  float mean[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 16; i++) {
+    for (int c = 0; c < channels; c++) mean[c] += rgba[i * 4 + c];
+  }
+  for (int c = 0; c < channels; c++) mean[c] /= 16.0f;
+
+  float covariance[4][4] = {};
+  float axis[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 16; i++) {
+    float d[4];
+    for (int c = 0; c < channels; c++) d[c] = rgba[i * 4 + c] - mean[c];
+    for (int a = 0; a < channels; a++) {
+      for (int b = 0; b < channels; b++) covariance[a][b] += d[a] * d[b];
+    }
+  }
+  // start from the bounding box diagonal, which is already close for most blocks
+  for (int c = 0; c < channels; c++) {
+    unsigned char lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++) {
+      unsigned char v = rgba[i * 4 + c];
+      lo = v < lo ? v : lo;
+      hi = v > hi ? v : hi;
+    }
+    axis[c] = (float)(hi - lo);
+  }
+  for (int iteration = 0; iteration < 8; iteration++) {
+    float next[4] = {0, 0, 0, 0};
+    float length = 0.0f;
+    for (int a = 0; a < channels; a++) {
+      for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+      length = next[a] * next[a] > length ? next[a] * next[a] : length;
+    }
+    if (length < 1e-12f) break;
+    for (int c = 0; c < channels; c++) axis[c] = next[c];
+    // keep the numbers in range; the direction is all that matters
+    float largest = 0.0f;
+    for (int c = 0; c < channels; c++) {
+      float magnitude = axis[c] < 0 ? -axis[c] : axis[c];
+      largest = magnitude > largest ? magnitude : largest;
+    }
+    for (int c = 0; c < channels; c++) axis[c] /= largest;
+  }
+
+  float axisLength = 0.0f;
+  for (int c = 0; c < channels; c++) axisLength += axis[c] * axis[c];
+  if (axisLength < 1e-12f) {
+    for (int c = 0; c < channels; c++) low[c] = high[c] = mean[c];
+    return;
+  }
+  float minT = 1e30f, maxT = -1e30f;
+  for (int i = 0; i < 16; i++) {
+    float t = 0.0f;
+    for (int c = 0; c < channels; c++) t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+    t /= axisLength;
+    minT = t < minT ? t : minT;
+    maxT = t > maxT ? t : maxT;
+  }
+  for (int c = 0; c < channels; c++) {
+    low[c] = mean[c] + axis[c] * minT;
+    high[c] = mean[c] + axis[c] * maxT;
+  }
+}
+
+int clampInt(float value, int lo, int hi) {
+  int rounded = (int)(value + 0.5f);
+  return rounded < lo ? lo : (rounded > hi ? hi : rounded);
+}
+
+int squaredDistance(const unsigned char* a, const int* b, int channels) {
+  int sum = 0;
+  for (int c = 0; c < channels; c++) {
+    int d = a[c] - b[c];
+    sum += d * d;
+  }
+  return sum;
+}
+
+std::uint16_t packColor565(const float* rgb) {
+  return (std::uint16_t)((clampInt(rgb[0] * 31.0f / 255.0f, 0, 31) << 11) |
+                         (clampInt(rgb[1] * 63.0f / 255.0f, 0, 63) << 5) |
+                         clampInt(rgb[2] * 31.0f / 255.0f, 0, 31));
+}
+
+void unpackColor565(std::uint16_t color, int* rgb) {
+  int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+  // bit replication, as the hardware expands them
+  rgb[0] = (r << 3) | (r >> 2);
+  rgb[1] = (g << 2) | (g >> 4);
+  rgb[2] = (b << 3) | (b >> 2);
+}
+
+// the 8 byte colour half shared by BC1 and BC3, always in four-colour mode
+void compressColorBlock(const unsigned char* rgba, unsigned char* out) {
+  float low[4], high[4];
+  principalEndpoints(rgba, 3, low, high);
+  std::uint16_t color0 = packColor565(high);
+  std::uint16_t color1 = packColor565(low);
+  // four-colour mode needs color0 > color1
+  if (color0 < color1) {
+    std::uint16_t swap = color0;
+    color0 = color1;
+    color1 = swap;
+  }
+  std::uint32_t indices = 0;
+  if (color0 != color1) {
+    int palette[4][3];
+    unpackColor565(color0, palette[0]);
+    unpackColor565(color1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+      palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+      palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+    for (int i = 0; i < 16; i++) {
+      int best = 0, bestError = 1 << 30;
+      for (int p = 0; p < 4; p++) {
+        int error = squaredDistance(rgba + i * 4, palette[p], 3);
+        if (error < bestError) {
+          best = p;
+          bestError = error;
+        }
+      }
+      indices |= (std::uint32_t)best << (2 * i);
+    }
+  }
+  out[0] = (unsigned char)(color0 & 0xFF);
+  out[1] = (unsigned char)(color0 >> 8);
+  out[2] = (unsigned char)(color1 & 0xFF);
+  out[3] = (unsigned char)(color1 >> 8);
+  for (int i = 0; i < 4; i++) out[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+// BC4-style alpha block: two 8-bit endpoints and an eight step ramp
+void compressAlphaBlock(const unsigned char* rgba, unsigned char* out) {
+  int alpha0 = 0, alpha1 = 255;
+  for (int i = 0; i < 16; i++) {
+    int a = rgba[i * 4 + 3];
+    alpha0 = a > alpha0 ? a : alpha0;
+    alpha1 = a < alpha1 ? a : alpha1;
+  }
+  std::uint64_t indices = 0;
+  if (alpha0 != alpha1) {
+    // alpha0 > alpha1 selects the eight value ramp: 0 and 1 are the endpoints, 2..7 between
+    int ramp[8] = {alpha0, alpha1};
+    for (int i = 1; i < 7; i++) ramp[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    for (int i = 0; i < 16; i++) {
+      int a = rgba[i * 4 + 3];
+      int best = 0, bestError = 1 << 30;
+      for (int p = 0; p < 8; p++) {
+        int error = (a - ramp[p]) * (a - ramp[p]);
+        if (error < bestError) {
+          best = p;
+          bestError = error;
+        }
+      }
+      indices |= (std::uint64_t)best << (3 * i);
+    }
+  }
+  out[0] = (unsigned char)alpha0;
+  out[1] = (unsigned char)alpha1;
+  for (int i = 0; i < 6; i++) out[2 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+// appends bits to a 128-bit block, least significant first
+struct BitWriter {
+  unsigned char* out;
+  int position;
+
+  void write(std::uint32_t value, int bits) {
+    for (int i = 0; i < bits; i++, position++) {
+      if ((value >> i) & 1) out[position >> 3] |= (unsigned char)(1 << (position & 7));
+    }
+  }
+};
+
+const int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// 8-bit endpoint to 7 bits plus a p-bit shared by all four channels of the endpoint
+void quantizeBC7Endpoint(const float* value, int* quantized, int* pBit) {
+  int bestError = 1 << 30;
+  for (int p = 0; p < 2; p++) {
+    int candidate[4];
+    int error = 0;
+    for (int c = 0; c < 4; c++) {
+      candidate[c] = clampInt((value[c] - p) / 2.0f, 0, 127);
+      int reconstructed = candidate[c] * 2 + p;
+      error += (int)((reconstructed - value[c]) * (reconstructed - value[c]));
+    }
+    if (error < bestError) {
+      bestError = error;
+      *pBit = p;
+      for (int c = 0; c < 4; c++) quantized[c] = candidate[c];
+    }
+  }
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+std::uint32_t blockFormatGL(BlockFormat format) {
+  switch (format) {
+    case BlockFormat::BC1:
+      return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    case BlockFormat::BC3:
+      return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    case BlockFormat::BC7:
+    default:
+      return GL_COMPRESSED_RGBA_BPTC_UNORM;
+  }
+}
+// ------------------------------------------------------------------------
+std::size_t compressedBlockBytes(std::uint32_t glFormat) {
+  switch (glFormat) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+      return 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+      return 16;
+    default:
+      return 0;
+  }
+}
+// ------------------------------------------------------------------------
+std::size_t compressedLevelSize(std::uint32_t glFormat, int width, int height) {
+  return (std::size_t)((width + 3) / 4) * ((height + 3) / 4) * compressedBlockBytes(glFormat);
+}
+// ------------------------------------------------------------------------
+void compressBlockBC1(const unsigned char* rgba, unsigned char* out) {
+  compressColorBlock(rgba, out);
+}
+// ------------------------------------------------------------------------
+void compressBlockBC3(const unsigned char* rgba, unsigned char* out) {
+  compressAlphaBlock(rgba, out);
+  compressColorBlock(rgba, out + 8);
+}
+// ------------------------------------------------------------------------
+void compressBlockBC7(const unsigned char* rgba, unsigned char* out) {
+  float low[4], high[4];
+  principalEndpoints(rgba, 4, low, high);
+  int endpoints[2][4], pBits[2];
+  quantizeBC7Endpoint(low, endpoints[0], &pBits[0]);
+  quantizeBC7Endpoint(high, endpoints[1], &pBits[1]);
+
+  int expanded[2][4];
+  for (int e = 0; e < 2; e++) {
+    for (int c = 0; c < 4; c++) expanded[e][c] = endpoints[e][c] * 2 + pBits[e];
+  }
+  int palette[16][4];
+  for (int i = 0; i < 16; i++) {
+    for (int c = 0; c < 4; c++) {
+      palette[i][c] =
+          ((64 - BC7_WEIGHTS4[i]) * expanded[0][c] + BC7_WEIGHTS4[i] * expanded[1][c] + 32) >> 6;
+    }
+  }
+  int indices[16];
+  for (int i = 0; i < 16; i++) {
+    int best = 0, bestError = 1 << 30;
+    for (int p = 0; p < 16; p++) {
+      int error = squaredDistance(rgba + i * 4, palette[p], 4);
+      if (error < bestError) {
+        best = p;
+        bestError = error;
+      }
+    }
+    indices[i] = best;
+  }
+  // the first index is stored without its top bit, so it has to be < 8: swap the ends if not
+  if (indices[0] & 8) {
+    for (int c = 0; c < 4; c++) {
+      int swap = endpoints[0][c];
+      endpoints[0][c] = endpoints[1][c];
+      endpoints[1][c] = swap;
+    }
+    int swap = pBits[0];
+    pBits[0] = pBits[1];
+    pBits[1] = swap;
+    for (int i = 0; i < 16; i++) indices[i] = 15 - indices[i];
+  }
+
+  std::memset(out, 0, 16);
+  BitWriter bits = {out, 0};
+  bits.write(1u << 6, 7);  // mode 6
+  for (int c = 0; c < 4; c++) {
+    bits.write((std::uint32_t)endpoints[0][c], 7);
+    bits.write((std::uint32_t)endpoints[1][c], 7);
+  }
+  bits.write((std::uint32_t)pBits[0], 1);
+  bits.write((std::uint32_t)pBits[1], 1);
+  bits.write((std::uint32_t)indices[0], 3);
+  for (int i = 1; i < 16; i++) bits.write((std::uint32_t)indices[i], 4);
+}
+// ------------------------------------------------------------------------
+void compressImage(BlockFormat format, const unsigned char* rgba, int width, int height,
+                   unsigned char* out) {
+  std::size_t blockBytes = compressedBlockBytes(blockFormatGL(format));
+  unsigned char block[16 * 4];
+  for (int by = 0; by < height; by += 4) {
+    for (int bx = 0; bx < width; bx += 4) {
+      // edge blocks repeat the last row/column; those texels are never sampled anyway
+      for (int y = 0; y < 4; y++) {
+        int sy = by + y < height ? by + y : height - 1;
+        for (int x = 0; x < 4; x++) {
+          int sx = bx + x < width ? bx + x : width - 1;
+          std::memcpy(block + (y * 4 + x) * 4, rgba + ((std::size_t)sy * width + sx) * 4, 4);
+        }
+      }
+      switch (format) {
+        case BlockFormat::BC1:
+          compressBlockBC1(block, out);
+          break;
+        case BlockFormat::BC3:
+          compressBlockBC3(block, out);
+          break;
+        case BlockFormat::BC7:
+          compressBlockBC7(block, out);
+          break;
+      }
+      out += blockBytes;
+    }
+  }
+}
@@ -0,0 +1,41 @@
+#include "image_rgba.h"
+#include <stb_image.h>
+
+#include <cstring>
+#include <iostream>
+
+// ------------------------------------------------------------------------
+bool decodeImageRGBA(const void* data, std::size_t size, bool flipVertically, ImageRGBA& image) {
+  // the per-thread flag, so loader workers decoding at the same time don't race on it
+  stbi_set_flip_vertically_on_load_thread(flipVertically);
+  int channels = 0;
+  unsigned char* pixels = stbi_load_from_memory((const stbi_uc*)data, (int)size, &image.width,
+                                                &image.height, &channels, 4);
+  if (!pixels) {
+    std::cout << "ERROR::TEXTURE::DECODE_FAILED: image in memory: "
+              << (stbi_failure_reason() ? stbi_failure_reason() : "unknown error") << std::endl;
+    return false;
+  }
+  image.pixels.assign(pixels, pixels + (std::size_t)image.width * image.height * 4);
+  stbi_image_free(pixels);
+  return true;
+}
+// ------------------------------------------------------------------------
+void blitPadded(unsigned char* dst, int dstWidth, int dstHeight, int x, int y,
+                const unsigned char* src, int width, int height, int padding) {
+  int top = y + height + padding < dstHeight ? y + height + padding : dstHeight;
+  int right = x + width + padding < dstWidth ? x + width + padding : dstWidth;
+  int bottom = y - padding > 0 ? y - padding : 0;
+  int left = x - padding > 0 ? x - padding : 0;
+  for (int row = bottom; row < top; row++) {
+    // rows above and below the image repeat its first and last row
+    int srcRow = row < y ? 0 : (row >= y + height ? height - 1 : row - y);
+    const unsigned char* in = src + (std::size_t)srcRow * width * 4;
+    unsigned char* out = dst + ((std::size_t)row * dstWidth) * 4;
+    for (int column = left; column < x; column++) std::memcpy(out + column * 4, in, 4);
+    std::memcpy(out + (std::size_t)x * 4, in, (std::size_t)width * 4);
+    for (int column = x + width; column < right; column++) {
+      std::memcpy(out + column * 4, in + (width - 1) * 4, 4);
+    }
+  }
+}
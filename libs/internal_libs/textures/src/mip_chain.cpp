@@ -0,0 +1,249 @@
+#include "mip_chain.h"
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_CHAIN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// Every level is built in 16-bit lanes: each source byte is widened (or, for sRGB colour,
+// looked up as 14-bit linear light), a 2x2 quad is summed and the sum turned back into a byte.
+// Four 14-bit values can't overflow 16 bits, so the sums stay in vector lanes throughout.
+const int LINEAR_BITS = 14;
+const int LINEAR_MAX = (1 << LINEAR_BITS) - 1;
+
+struct SrgbTables {
+  std::uint16_t toLinear[256];
+  // indexed by the 14-bit average
+  unsigned char fromLinear[LINEAR_MAX + 1];
+  // alpha only changes scale, so it can share the lanes with colour
+  std::uint16_t alphaToLinear[256];
+  unsigned char alphaFromLinear[LINEAR_MAX + 1];
+};
+
+const SrgbTables& srgbTables() {
+  static const SrgbTables tables = [] {
+    SrgbTables result;
+    for (int i = 0; i < 256; i++) {
+      double c = i / 255.0;
+      double linear = c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+      result.toLinear[i] = (std::uint16_t)std::lround(linear * LINEAR_MAX);
+      result.alphaToLinear[i] = (std::uint16_t)((i * LINEAR_MAX + 127) / 255);
+    }
+    for (int i = 0; i <= LINEAR_MAX; i++) {
+      double linear = (double)i / LINEAR_MAX;
+      double c = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+      result.fromLinear[i] = (unsigned char)std::lround(c * 255.0);
+      result.alphaFromLinear[i] = (unsigned char)((i * 255 + LINEAR_MAX / 2) / LINEAR_MAX);
+    }
+    return result;
+  }();
+  return tables;
+}
+
+// alpha (the last channel of RG/RGBA images) is coverage, not light, and is never converted
+bool isAlpha(int channel, int channels) {
+  return (channels == 2 || channels == 4) && channel == channels - 1;
+}
+
+// ------------------------------------------------------------------------
+void widenRow(const unsigned char* in, std::size_t count, std::uint16_t* out) {
+  std::size_t i = 0;
+#ifdef MIP_CHAIN_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= count; i += 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*)(in + i));
+    _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpackhi_epi8(bytes, zero));
+  }
+#endif
+  for (; i < count; i++) out[i] = in[i];
+}
+// ------------------------------------------------------------------------
+void linearizeRow(const unsigned char* in, int width, int channels, std::uint16_t* out) {
+  const SrgbTables& tables = srgbTables();
+  const std::uint16_t* table[4];
+  for (int c = 0; c < channels; c++) {
+    table[c] = isAlpha(c, channels) ? tables.alphaToLinear : tables.toLinear;
+  }
+  for (int x = 0; x < width; x++) {
+    for (int c = 0; c < channels; c++) *out++ = table[c][*in++];
+  }
+}
+// ------------------------------------------------------------------------
+void addRows(const std::uint16_t* row0, const std::uint16_t* row1, std::size_t count,
+             std::uint16_t* out) {
+  std::size_t i = 0;
+#ifdef MIP_CHAIN_SSE2
+  for (; i + 8 <= count; i += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(row0 + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(row1 + i));
+    _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi16(a, b));
+  }
+#endif
+  for (; i < count; i++) out[i] = (std::uint16_t)(row0[i] + row1[i]);
+}
+// Sum horizontally adjacent pixels of the vertical sums. Levels halve rounding down, so an odd
+// last column has no destination pixel and is dropped, as the old filter (and
+// glGenerateMipmap's box filter) did; only a 1-pixel-wide source pairs its column with itself.
+// ------------------------------------------------------------------------
+void addColumns(const std::uint16_t* in, int srcWidth, int dstWidth, int channels,
+                std::uint16_t* out) {
+  int x = 0;
+#ifdef MIP_CHAIN_SSE2
+  if (channels == 4) {
+    // four source pixels per step: [p0 p1] [p2 p3] -> [p0 p2] + [p1 p3]
+    for (; x + 2 <= dstWidth && 2 * x + 3 < srcWidth; x += 2) {
+      __m128i a = _mm_loadu_si128((const __m128i*)(in + 8 * x));
+      __m128i b = _mm_loadu_si128((const __m128i*)(in + 8 * x + 8));
+      __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(a, b), _mm_unpackhi_epi64(a, b));
+      _mm_storeu_si128((__m128i*)(out + 4 * x), sum);
+    }
+  }
+#endif
+  for (; x < dstWidth; x++) {
+    int x0 = 2 * x * channels;
+    int x1 = 2 * x + 1 < srcWidth ? x0 + channels : x0;
+    for (int c = 0; c < channels; c++) {
+      out[x * channels + c] = (std::uint16_t)(in[x0 + c] + in[x1 + c]);
+    }
+  }
+}
+// ------------------------------------------------------------------------
+void averageRow(const std::uint16_t* sums, std::size_t count, unsigned char* out) {
+  std::size_t i = 0;
+#ifdef MIP_CHAIN_SSE2
+  const __m128i two = _mm_set1_epi16(2);
+  for (; i + 16 <= count; i += 16) {
+    __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i*)(sums + i)), two), 2);
+    __m128i hi =
+        _mm_srli_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i*)(sums + i + 8)), two), 2);
+    _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(lo, hi));
+  }
+#endif
+  for (; i < count; i++) out[i] = (unsigned char)((sums[i] + 2) >> 2);
+}
+// ------------------------------------------------------------------------
+void delinearizeRow(const std::uint16_t* sums, int width, int channels, unsigned char* out) {
+  const SrgbTables& tables = srgbTables();
+  const unsigned char* table[4];
+  for (int c = 0; c < channels; c++) {
+    table[c] = isAlpha(c, channels) ? tables.alphaFromLinear : tables.fromLinear;
+  }
+  for (int x = 0; x < width; x++) {
+    for (int c = 0; c < channels; c++) *out++ = table[c][(*sums++ + 2u) >> 2];
+  }
+}
+#ifdef MIP_CHAIN_SSE2
+// RGBA8 without a curve is the common case, so it skips the 16-bit rows: four destination
+// pixels per step straight from the two source rows, the rest at the end one at a time
+// ------------------------------------------------------------------------
+void downsampleRowRGBA8(const unsigned char* in0, const unsigned char* in1, int srcWidth,
+                       int dstWidth, unsigned char* out) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i two = _mm_set1_epi16(2);
+  int x = 0;
+  for (; x + 4 <= dstWidth && 2 * x + 7 < srcWidth; x += 4) {
+    __m128i a0 = _mm_loadu_si128((const __m128i*)(in0 + 8 * x));
+    __m128i a1 = _mm_loadu_si128((const __m128i*)(in0 + 8 * x + 16));
+    __m128i b0 = _mm_loadu_si128((const __m128i*)(in1 + 8 * x));
+    __m128i b1 = _mm_loadu_si128((const __m128i*)(in1 + 8 * x + 16));
+    // vertical sums, two source pixels per register
+    __m128i p01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+    __m128i p23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+    __m128i p45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+    __m128i p67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+    // horizontal: [p0 p1] [p2 p3] -> [p0 p2] + [p1 p3]
+    __m128i q01 = _mm_add_epi16(_mm_unpacklo_epi64(p01, p23), _mm_unpackhi_epi64(p01, p23));
+    __m128i q23 = _mm_add_epi16(_mm_unpacklo_epi64(p45, p67), _mm_unpackhi_epi64(p45, p67));
+    q01 = _mm_srli_epi16(_mm_add_epi16(q01, two), 2);
+    q23 = _mm_srli_epi16(_mm_add_epi16(q23, two), 2);
+    _mm_storeu_si128((__m128i*)(out + 4 * x), _mm_packus_epi16(q01, q23));
+  }
+  for (; x < dstWidth; x++) {
+    int x0 = 8 * x;
+    int x1 = 2 * x + 1 < srcWidth ? x0 + 4 : x0;
+    for (int c = 0; c < 4; c++) {
+      unsigned int sum = in0[x0 + c] + in0[x1 + c] + in1[x0 + c] + in1[x1 + c];
+      out[4 * x + c] = (unsigned char)((sum + 2) >> 2);
+    }
+  }
+}
+#endif
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+std::vector<MipLevel> mipLayout(int width, int height, int channels, bool mipmapped) {
+  std::vector<MipLevel> levels;
+  std::size_t offset = 0;
+  for (;;) {
+    MipLevel level;
+    level.width = width;
+    level.height = height;
+    level.offset = offset;
+    level.size = (std::size_t)width * height * channels;
+    levels.push_back(level);
+    offset += level.size;
+    if (!mipmapped || (width == 1 && height == 1)) break;
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+  }
+  return levels;
+}
+// ------------------------------------------------------------------------
+std::size_t mipChainSize(const std::vector<MipLevel>& levels) {
+  return levels.empty() ? 0 : levels.back().offset + levels.back().size;
+}
+// ------------------------------------------------------------------------
+void generateMipChain(unsigned char* image, const std::vector<MipLevel>& levels, int channels,
+                      bool srgb) {
+  if (levels.size() < 2) return;
+  // only the sRGB colour formats have a transfer curve to undo
+  srgb = srgb && channels >= 3;
+  std::size_t rowCapacity = (std::size_t)levels[0].width * channels;
+  std::vector<std::uint16_t> scratch(rowCapacity * 3);
+  std::uint16_t* row0 = scratch.data();
+  std::uint16_t* row1 = row0 + rowCapacity;
+  std::uint16_t* sums = row1 + rowCapacity;
+  for (std::size_t i = 1; i < levels.size(); i++) {
+    const MipLevel& src = levels[i - 1];
+    const MipLevel& dst = levels[i];
+    const unsigned char* in = image + src.offset;
+    unsigned char* out = image + dst.offset;
+    std::size_t srcStride = (std::size_t)src.width * channels;
+    std::size_t dstStride = (std::size_t)dst.width * channels;
+    for (int y = 0; y < dst.height; y++) {
+      // as with columns, an odd last row is dropped and a 1-pixel-high source pairs with itself
+      const unsigned char* in0 = in + (std::size_t)(2 * y) * srcStride;
+      const unsigned char* in1 = 2 * y + 1 < src.height ? in0 + srcStride : in0;
+#ifdef MIP_CHAIN_SSE2
+      if (!srgb && channels == 4) {
+        downsampleRowRGBA8(in0, in1, src.width, dst.width, out);
+        out += dstStride;
+        continue;
+      }
+#endif
+      if (srgb) {
+        linearizeRow(in0, src.width, channels, row0);
+        linearizeRow(in1, src.width, channels, row1);
+      } else {
+        widenRow(in0, srcStride, row0);
+        widenRow(in1, srcStride, row1);
+      }
+      // the vertical sums overwrite row0, then the quads go to `sums`
+      addRows(row0, row1, srcStride, row0);
+      addColumns(row0, src.width, dst.width, channels, sums);
+      if (srgb) {
+        delinearizeRow(sums, dst.width, channels, out);
+      } else {
+        averageRow(sums, dstStride, out);
+      }
+      out += dstStride;
+    }
+  }
+}
@@ -0,0 +1,134 @@
+#include "pixel_upload_ring.h"
+#include <gl_ext.h>
+#include <glad/glad.h>
+
+#include <iostream>
+
+namespace {
+
+// keeps every slot's start aligned for the driver's DMA engine and for SIMD copies
+const std::size_t SLOT_ALIGNMENT = 256;
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+PixelUploadRing::PixelUploadRing(unsigned int slotCount, std::size_t slotSize)
+    : size((slotSize + SLOT_ALIGNMENT - 1) & ~(SLOT_ALIGNMENT - 1)),
+      persistentMapping(glExtensions().bufferStorage) {
+  slots.resize(slotCount);
+  if (persistentMapping) {
+    // one buffer for the whole ring, mapped for as long as it exists
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glExtensions().bufferStorageData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)(size * slotCount),
+                                     NULL, flags);
+    unsigned char* base = (unsigned char*)glMapBufferRange(
+        GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)(size * slotCount), flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (!base) std::cout << "ERROR::PIXEL_UPLOAD_RING::MAP_FAILED" << std::endl;
+    for (unsigned int i = 0; i < slotCount; i++) {
+      slots[i].buffer = buffer;
+      slots[i].offset = i * size;
+      slots[i].mapped = base ? base + i * size : nullptr;
+    }
+  } else {
+    for (Slot& slot : slots) {
+      glGenBuffers(1, &slot.buffer);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+      slot.offset = 0;
+      slot.mapped = nullptr;
+      map(slot);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+  for (Slot& slot : slots) {
+    slot.fence = 0;
+    // a slot that couldn't be mapped is never handed out
+    slot.state = slot.mapped ? State::Free : State::Uploading;
+  }
+}
+// explicit mapping: the old contents are never needed again, so let the driver orphan them
+// ------------------------------------------------------------------------
+void PixelUploadRing::map(Slot& slot) {
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+  slot.mapped = (unsigned char*)glMapBufferRange(
+      GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+  if (!slot.mapped) std::cout << "ERROR::PIXEL_UPLOAD_RING::MAP_FAILED" << std::endl;
+}
+// ------------------------------------------------------------------------
+bool PixelUploadRing::persistent() const { return persistentMapping; }
+
+std::size_t PixelUploadRing::slotSize() const { return size; }
+// ------------------------------------------------------------------------
+int PixelUploadRing::acquire(std::size_t bytes) {
+  if (bytes > size) return -1;
+  std::lock_guard<std::mutex> lock(mutex);
+  for (std::size_t i = 0; i < slots.size(); i++) {
+    if (slots[i].state == State::Free) {
+      slots[i].state = State::Writing;
+      return (int)i;
+    }
+  }
+  return -1;
+}
+// ------------------------------------------------------------------------
+unsigned char* PixelUploadRing::data(int slot) const { return slots[slot].mapped; }
+// ------------------------------------------------------------------------
+const void* PixelUploadRing::beginUpload(int slot) {
+  Slot& s = slots[slot];
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.buffer);
+  if (!persistentMapping && s.mapped) {
+    // the mapped pointer dies here; GL_FALSE means the contents were lost (e.g. mode switch)
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+      std::cout << "ERROR::PIXEL_UPLOAD_RING::DATA_LOST" << std::endl;
+    }
+    s.mapped = nullptr;
+  }
+  return (const void*)s.offset;
+}
+// ------------------------------------------------------------------------
+void PixelUploadRing::endUpload(int slot, bool last) {
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  if (!last) return;
+  std::lock_guard<std::mutex> lock(mutex);
+  slots[slot].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slots[slot].state = State::Uploading;
+}
+// ------------------------------------------------------------------------
+void PixelUploadRing::recycle() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (Slot& slot : slots) {
+    if (slot.state != State::Uploading || !slot.fence) continue;
+    // timeout 0 only polls; flushing makes sure the fence gets to the GPU at all
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+    glDeleteSync(slot.fence);
+    slot.fence = 0;
+    if (!persistentMapping) {
+      map(slot);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (slot.mapped) slot.state = State::Free;
+  }
+}
+// ------------------------------------------------------------------------
+void PixelUploadRing::release() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (Slot& slot : slots) {
+    if (slot.fence) glDeleteSync(slot.fence);
+    slot.fence = 0;
+    slot.state = State::Uploading;
+    slot.mapped = nullptr;
+  }
+  if (slots.empty()) return;
+  if (persistentMapping) {
+    // deleting a buffer unmaps it
+    glDeleteBuffers(1, &slots[0].buffer);
+  } else {
+    for (Slot& slot : slots) glDeleteBuffers(1, &slot.buffer);
+  }
+  slots.clear();
+}
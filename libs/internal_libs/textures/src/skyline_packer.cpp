@@ -0,0 +1,79 @@
+#include "skyline_packer.h"
+
+#include <cstddef>
+
+// ------------------------------------------------------------------------
+SkylinePacker::SkylinePacker(int width, int height) : binWidth(width), binHeight(height) {
+  reset();
+}
+// ------------------------------------------------------------------------
+void SkylinePacker::reset() {
+  usedArea = 0;
+  skyline.assign(1, Segment{0, 0, binWidth});
+}
+// ------------------------------------------------------------------------
+int SkylinePacker::fitAt(std::size_t index, int width, int height) const {
+  int x = skyline[index].x;
+  if (x + width > binWidth) return -1;
+  // the rectangle rests on the highest segment it spans
+  int y = 0;
+  int remaining = width;
+  for (std::size_t i = index; remaining > 0; i++) {
+    if (skyline[i].y > y) y = skyline[i].y;
+    if (y + height > binHeight) return -1;
+    remaining -= skyline[i].width;
+  }
+  return y;
+}
+// ------------------------------------------------------------------------
+bool SkylinePacker::insert(int width, int height, int& x, int& y) {
+  if (width <= 0 || height <= 0) return false;
+  std::size_t best = skyline.size();
+  int bestTop = binHeight + 1;
+  int bestWidth = 0;
+  for (std::size_t i = 0; i < skyline.size(); i++) {
+    int fit = fitAt(i, width, height);
+    if (fit < 0) continue;
+    int top = fit + height;
+    if (top < bestTop || (top == bestTop && skyline[i].width < bestWidth)) {
+      best = i;
+      bestTop = top;
+      bestWidth = skyline[i].width;
+    }
+  }
+  if (best == skyline.size()) return false;
+  x = skyline[best].x;
+  y = bestTop - height;
+
+  // the new top replaces every segment it covers; the last one covered may survive in part
+  skyline.insert(skyline.begin() + best, Segment{x, bestTop, width});
+  std::size_t next = best + 1;
+  while (next < skyline.size() && skyline[next].x < x + width) {
+    int shrink = x + width - skyline[next].x;
+    if (shrink < skyline[next].width) {
+      skyline[next].x += shrink;
+      skyline[next].width -= shrink;
+      break;
+    }
+    skyline.erase(skyline.begin() + next);
+  }
+  // neighbours at the same height are one segment
+  for (std::size_t i = 0; i + 1 < skyline.size();) {
+    if (skyline[i].y == skyline[i + 1].y) {
+      skyline[i].width += skyline[i + 1].width;
+      skyline.erase(skyline.begin() + i + 1);
+    } else {
+      i++;
+    }
+  }
+  usedArea += (long long)width * height;
+  return true;
+}
+// ------------------------------------------------------------------------
+int SkylinePacker::width() const { return binWidth; }
+
+int SkylinePacker::height() const { return binHeight; }
+
+float SkylinePacker::occupancy() const {
+  return (float)((double)usedArea / ((double)binWidth * binHeight));
+}
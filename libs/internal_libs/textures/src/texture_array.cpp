@@ -0,0 +1,73 @@
+#include "texture_array.h"
+#include "image_rgba.h"
+#include "mip_chain.h"
+#include <gl_state.h>
+
+#include <iostream>
+
+// ------------------------------------------------------------------------
+TextureArray::TextureArray(int width, int height, int layers, const TextureOptions& options)
+    : ID(0), layerWidth(width), layerHeight(height), layers(layers), options(options) {
+  glGenTextures(1, &ID);
+  glState().bindTexture(GL_TEXTURE_2D_ARRAY, ID);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, options.wrap);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, options.wrap);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, options.minFilter);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, options.magFilter);
+  std::vector<MipLevel> levels = mipLayout(width, height, 4, options.generateMipmaps);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+  GLint internalFormat = options.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+  for (std::size_t i = 0; i < levels.size(); i++) {
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, internalFormat, levels[i].width,
+                 levels[i].height, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  }
+}
+// ------------------------------------------------------------------------
+int TextureArray::add(const unsigned char* rgba, int width, int height) {
+  int layer = (int)regions.size();
+  if (layer >= layers) return -1;
+  if (width > layerWidth || height > layerHeight) {
+    std::cout << "ERROR::TEXTURE::ARRAY_LAYER_TOO_SMALL: " << width << "x" << height
+              << " image in " << layerWidth << "x" << layerHeight << " layers" << std::endl;
+    return -1;
+  }
+  // the whole layer is written, so its mips never average in undefined texels
+  std::vector<MipLevel> levels = mipLayout(layerWidth, layerHeight, 4, options.generateMipmaps);
+  std::vector<unsigned char> chain(mipChainSize(levels));
+  blitPadded(chain.data(), layerWidth, layerHeight, 0, 0, rgba, width, height,
+             layerWidth > layerHeight ? layerWidth : layerHeight);
+  generateMipChain(chain.data(), levels, 4, options.srgb);
+
+  glState().bindTexture(GL_TEXTURE_2D_ARRAY, ID);
+  for (std::size_t i = 0; i < levels.size(); i++) {
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, (GLint)i, 0, 0, layer, levels[i].width,
+                    levels[i].height, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+                    chain.data() + levels[i].offset);
+  }
+
+  TextureRegion region;
+  region.layer = layer;
+  region.u1 = (float)width / layerWidth;
+  region.v1 = (float)height / layerHeight;
+  regions.push_back(region);
+  return layer;
+}
+// ------------------------------------------------------------------------
+int TextureArray::addEncoded(const void* data, std::size_t size, bool flipVertically) {
+  ImageRGBA image;
+  if (!decodeImageRGBA(data, size, flipVertically, image)) return -1;
+  return add(image.pixels.data(), image.width, image.height);
+}
+// ------------------------------------------------------------------------
+const TextureRegion& TextureArray::region(int layer) const { return regions[layer]; }
+
+int TextureArray::layerCount() const { return layers; }
+
+int TextureArray::usedLayers() const { return (int)regions.size(); }
+// ------------------------------------------------------------------------
+void TextureArray::release() {
+  if (ID == 0) return;
+  glState().forgetTexture(ID);
+  glDeleteTextures(1, &ID);
+  ID = 0;
+}
@@ -0,0 +1,74 @@
+#include "texture_atlas.h"
+#include "image_rgba.h"
+#include "mip_chain.h"
+#include <gl_state.h>
+
+#include <cstring>
+
+// ------------------------------------------------------------------------
+TextureAtlas::TextureAtlas(int width, int height, int padding)
+    : ID(0),
+      atlasWidth(width),
+      atlasHeight(height),
+      padding(padding),
+      packer(width, height),
+      pixels((std::size_t)width * height * 4, 0) {}
+// ------------------------------------------------------------------------
+int TextureAtlas::add(const unsigned char* rgba, int width, int height) {
+  int x = 0, y = 0;
+  if (!packer.insert(width + 2 * padding, height + 2 * padding, x, y)) return -1;
+  x += padding;
+  y += padding;
+  blitPadded(pixels.data(), atlasWidth, atlasHeight, x, y, rgba, width, height, padding);
+
+  TextureRegion region;
+  region.u0 = (float)x / atlasWidth;
+  region.v0 = (float)y / atlasHeight;
+  region.u1 = (float)(x + width) / atlasWidth;
+  region.v1 = (float)(y + height) / atlasHeight;
+  regions.push_back(region);
+  return (int)regions.size() - 1;
+}
+// ------------------------------------------------------------------------
+int TextureAtlas::addEncoded(const void* data, std::size_t size, bool flipVertically) {
+  ImageRGBA image;
+  if (!decodeImageRGBA(data, size, flipVertically, image)) return -1;
+  return add(image.pixels.data(), image.width, image.height);
+}
+// ------------------------------------------------------------------------
+const TextureRegion& TextureAtlas::region(int index) const { return regions[index]; }
+
+std::size_t TextureAtlas::regionCount() const { return regions.size(); }
+
+float TextureAtlas::occupancy() const { return packer.occupancy(); }
+// ------------------------------------------------------------------------
+unsigned int TextureAtlas::upload(const TextureOptions& options) {
+  int levelCount = 1;
+  while (options.generateMipmaps && (padding >> levelCount) > 0) levelCount++;
+  std::vector<MipLevel> levels = mipLayout(atlasWidth, atlasHeight, 4, levelCount > 1);
+  if (levels.size() > (std::size_t)levelCount) levels.resize(levelCount);
+  std::vector<unsigned char> chain(mipChainSize(levels));
+  std::memcpy(chain.data(), pixels.data(), pixels.size());
+  generateMipChain(chain.data(), levels, 4, options.srgb);
+
+  if (ID == 0) glGenTextures(1, &ID);
+  glState().bindTexture(GL_TEXTURE_2D, ID);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, options.minFilter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, options.magFilter);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+  GLint internalFormat = options.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+  for (std::size_t i = 0; i < levels.size(); i++) {
+    glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, levels[i].width, levels[i].height, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, chain.data() + levels[i].offset);
+  }
+  return ID;
+}
+// ------------------------------------------------------------------------
+void TextureAtlas::release() {
+  if (ID == 0) return;
+  glState().forgetTexture(ID);
+  glDeleteTextures(1, &ID);
+  ID = 0;
+}
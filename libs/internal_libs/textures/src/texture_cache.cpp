@@ -0,0 +1,180 @@
+#include "texture_cache.h"
+#include "block_compression.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+struct TextureCacheHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint64_t key;
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint32_t channels;
+  std::uint32_t format;  // GL compressed internal format, 0 for plain pixels
+  std::uint32_t levelCount;
+  std::uint64_t dataOffset;  // from the start of the file
+  std::uint64_t dataSize;
+};
+struct TextureCacheLevel {
+  std::uint32_t width;
+  std::uint32_t height;
+  std::uint64_t offset;  // from dataOffset
+  std::uint64_t size;
+};
+const char TEXTURE_CACHE_MAGIC[4] = {'G', 'L', 'T', 'X'};
+const std::uint32_t TEXTURE_CACHE_VERSION = 2;
+// level data starts on a boundary that suits both the page cache and SIMD copies
+const std::uint64_t TEXTURE_CACHE_ALIGNMENT = 64;
+// more levels than a 2^31 texture could have means the file is garbage
+const std::uint32_t MAX_LEVELS = 32;
+
+std::string textureCachePath(const std::string& directory, std::uint64_t key) {
+  char fileName[32];
+  std::snprintf(fileName, sizeof(fileName), "%016llx.tex", (unsigned long long)key);
+  return (std::filesystem::path(directory) / fileName).string();
+}
+
+}  // namespace
+
+// ------------------------------------------------------------------------
+TextureCacheFile::TextureCacheFile() : imageChannels(0), imageFormat(0), pixels(nullptr) {}
+// ------------------------------------------------------------------------
+TextureCacheFile::TextureCacheFile(const std::string& directory, std::uint64_t key)
+    : file(textureCachePath(directory, key)), imageChannels(0), imageFormat(0), pixels(nullptr) {
+  if (file.isOpen()) parse(file.data(), file.size(), &key);
+}
+// ------------------------------------------------------------------------
+TextureCacheFile TextureCacheFile::open(const std::string& path) {
+  TextureCacheFile result;
+  result.file = MappedFile(path);
+  if (result.file.isOpen()) result.parse(result.file.data(), result.file.size(), nullptr);
+  return result;
+}
+// ------------------------------------------------------------------------
+TextureCacheFile TextureCacheFile::fromMemory(const void* data, std::size_t size) {
+  TextureCacheFile result;
+  result.parse((const unsigned char*)data, size, nullptr);
+  return result;
+}
+// ------------------------------------------------------------------------
+bool TextureCacheFile::isContainer(const void* data, std::size_t size) {
+  return size >= sizeof(TextureCacheHeader) &&
+         std::memcmp(data, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) == 0;
+}
+// check everything the upload will rely on before trusting any of it
+// ------------------------------------------------------------------------
+void TextureCacheFile::parse(const unsigned char* bytes, std::size_t size,
+                             const std::uint64_t* expectedKey) {
+  if (!isContainer(bytes, size)) return;
+  TextureCacheHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (header.version != TEXTURE_CACHE_VERSION || (expectedKey && header.key != *expectedKey) ||
+      header.levelCount == 0 || header.levelCount > MAX_LEVELS || header.channels < 1 ||
+      header.channels > 4) {
+    return;
+  }
+  if (header.format != 0 && compressedBlockBytes(header.format) == 0) return;
+  std::uint64_t tableEnd =
+      sizeof(TextureCacheHeader) + (std::uint64_t)header.levelCount * sizeof(TextureCacheLevel);
+  if (tableEnd > header.dataOffset || header.dataOffset > size ||
+      header.dataSize > size - header.dataOffset) {
+    return;
+  }
+  std::vector<MipLevel> levels(header.levelCount);
+  for (std::uint32_t i = 0; i < header.levelCount; i++) {
+    TextureCacheLevel level;
+    std::memcpy(&level, bytes + sizeof(TextureCacheHeader) + i * sizeof(level), sizeof(level));
+    std::uint64_t expectedSize =
+        header.format != 0
+            ? compressedLevelSize(header.format, (int)level.width, (int)level.height)
+            : (std::uint64_t)level.width * level.height * header.channels;
+    // a level that runs past the data would have the upload read past the mapping
+    if (level.offset > header.dataSize || level.size > header.dataSize - level.offset ||
+        level.size != expectedSize) {
+      return;
+    }
+    levels[i].width = (int)level.width;
+    levels[i].height = (int)level.height;
+    levels[i].offset = (std::size_t)level.offset;
+    levels[i].size = (std::size_t)level.size;
+  }
+  mipLevels.swap(levels);
+  imageChannels = (int)header.channels;
+  imageFormat = header.format;
+  pixels = bytes + header.dataOffset;
+}
+// ------------------------------------------------------------------------
+bool TextureCacheFile::valid() const { return pixels != nullptr; }
+
+int TextureCacheFile::width() const { return mipLevels.empty() ? 0 : mipLevels[0].width; }
+
+int TextureCacheFile::height() const { return mipLevels.empty() ? 0 : mipLevels[0].height; }
+
+int TextureCacheFile::channels() const { return imageChannels; }
+
+std::uint32_t TextureCacheFile::format() const { return imageFormat; }
+
+const std::vector<MipLevel>& TextureCacheFile::levels() const { return mipLevels; }
+
+const unsigned char* TextureCacheFile::data() const { return pixels; }
+// ------------------------------------------------------------------------
+bool TextureCacheFile::store(const std::string& directory, std::uint64_t key, int channels,
+                             const std::vector<MipLevel>& levels, const unsigned char* data) {
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  return write(textureCachePath(directory, key), key, 0, channels, levels, data);
+}
+// ------------------------------------------------------------------------
+bool TextureCacheFile::write(const std::string& path, std::uint64_t key, std::uint32_t format,
+                             int channels, const std::vector<MipLevel>& levels,
+                             const unsigned char* data) {
+  if (levels.empty() || levels.size() > MAX_LEVELS) return false;
+  // workers can store at the same time (the same image loaded twice), so each writes its
+  // own temporary; the rename makes the file appear complete or not at all
+  static std::atomic<unsigned int> counter(0);
+  std::string tempPath = path + ".tmp" + std::to_string(counter++);
+
+  std::uint64_t tableEnd = sizeof(TextureCacheHeader) + levels.size() * sizeof(TextureCacheLevel);
+  TextureCacheHeader header;
+  // zeroed so the padding after levelCount is too: the same input gives the same bytes
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+  header.version = TEXTURE_CACHE_VERSION;
+  header.key = key;
+  header.width = (std::uint32_t)levels[0].width;
+  header.height = (std::uint32_t)levels[0].height;
+  header.channels = (std::uint32_t)channels;
+  header.format = format;
+  header.levelCount = (std::uint32_t)levels.size();
+  header.dataOffset = (tableEnd + TEXTURE_CACHE_ALIGNMENT - 1) & ~(TEXTURE_CACHE_ALIGNMENT - 1);
+  header.dataSize = mipChainSize(levels);
+  std::error_code error;
+  {
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    out.write((const char*)&header, sizeof(header));
+    for (const MipLevel& level : levels) {
+      TextureCacheLevel entry = {(std::uint32_t)level.width, (std::uint32_t)level.height,
+                                 level.offset, level.size};
+      out.write((const char*)&entry, sizeof(entry));
+    }
+    const char padding[TEXTURE_CACHE_ALIGNMENT] = {};
+    out.write(padding, (std::streamsize)(header.dataOffset - tableEnd));
+    out.write((const char*)data, (std::streamsize)header.dataSize);
+    if (!out) {
+      out.close();
+      std::filesystem::remove(tempPath, error);
+      return false;
+    }
+  }
+  std::filesystem::rename(tempPath, path, error);
+  if (!error) return true;
+  std::filesystem::remove(tempPath, error);
+  return false;
+}
@@ -0,0 +1,160 @@
+#include "texture_manager.h"
+#include <gl_state.h>
+
+#include <algorithm>
+
+// ------------------------------------------------------------------------
+TextureManager::TextureManager(AsyncTextureLoader& loader, std::size_t budgetBytes)
+    : loader(loader), budgetBytes(budgetBytes), resident(0), frame(1), unloadAfter(600) {
+  loader.recordUploads(true);
+}
+// ------------------------------------------------------------------------
+TextureManager::Handle TextureManager::add(const void* data, std::size_t size,
+                                           const TextureOptions& options) {
+  Entry entry = {};
+  entry.data = data;
+  entry.size = size;
+  entry.options = options;
+  return addEntry(entry);
+}
+TextureManager::Handle TextureManager::add(const std::string& path,
+                                           const TextureOptions& options) {
+  Entry entry = {};
+  entry.path = path;
+  entry.options = options;
+  return addEntry(entry);
+}
+TextureManager::Handle TextureManager::addCooked(const void* cooked, std::size_t cookedSize,
+                                                 const void* source, std::size_t sourceSize,
+                                                 const TextureOptions& options) {
+  Entry entry = {};
+  entry.data = source;
+  entry.size = sourceSize;
+  entry.cooked = cooked;
+  entry.cookedSize = cookedSize;
+  entry.options = options;
+  return addEntry(entry);
+}
+TextureManager::Handle TextureManager::addEntry(const Entry& entry) {
+  entries.push_back(entry);
+  return (Handle)entries.size() - 1;
+}
+// ------------------------------------------------------------------------
+unsigned int TextureManager::use(Handle handle) {
+  Entry& entry = entries[handle];
+  entry.lastUsed = frame;
+  // a source that failed to load would fail again; don't decode it every frame
+  if (entry.pending == 0 && !entry.failed) {
+    if (entry.texture == 0) {
+      request(entry, 0);
+    } else if (entry.skipLevels > 0) {
+      // back to full size if that fits; each dropped level is a quarter of what's left
+      std::size_t full = entry.bytes << (2 * entry.skipLevels);
+      if (resident - entry.bytes + full <= budgetBytes) request(entry, 0);
+    }
+  }
+  // a first load streams its smallest levels in first and the loader keeps BASE_LEVEL at the
+  // ones present, so it's drawable long before the chain is complete; its bytes are counted
+  // once finishUpload() sees it land
+  if (entry.texture == 0 && entry.pending != 0) return entry.pending;
+  return entry.texture;
+}
+// ------------------------------------------------------------------------
+void TextureManager::request(Entry& entry, int skipLevels) {
+  TextureOptions options = entry.options;
+  options.skipLevels = skipLevels;
+  if (entry.cooked) {
+    entry.pending = loader.loadCooked(entry.cooked, entry.cookedSize, entry.data, entry.size,
+                                      options);
+  } else if (entry.data) {
+    entry.pending = loader.load(entry.data, entry.size, options);
+  } else {
+    entry.pending = loader.load(entry.path, options);
+  }
+  entry.pendingSkip = skipLevels;
+}
+// ------------------------------------------------------------------------
+void TextureManager::update() {
+  for (const TextureUpload& upload : loader.takeUploads()) finishUpload(upload);
+  enforceBudget();
+  frame++;
+}
+// swap a finished load in for the texture it replaces
+// ------------------------------------------------------------------------
+void TextureManager::finishUpload(const TextureUpload& upload) {
+  std::vector<Entry>::iterator entry =
+      std::find_if(entries.begin(), entries.end(),
+                   [&](const Entry& candidate) { return candidate.pending == upload.texture; });
+  // uploads of textures the app loaded itself aren't ours to count
+  if (entry == entries.end()) return;
+  entry->pending = 0;
+  if (upload.failed) {
+    entry->failed = true;
+    glState().forgetTexture(upload.texture);
+    glDeleteTextures(1, &upload.texture);
+    return;
+  }
+  unload(*entry);
+  entry->texture = upload.texture;
+  entry->bytes = upload.bytes;
+  entry->skipLevels = entry->pendingSkip;
+  entry->levelCount = upload.levelCount + entry->pendingSkip;
+  resident += upload.bytes;
+}
+// ------------------------------------------------------------------------
+void TextureManager::enforceBudget() {
+  // shrinks in flight free their share once they land; count it already so one pass
+  // doesn't shrink more than it has to
+  std::size_t relief = 0;
+  std::vector<Entry*> candidates;
+  for (Entry& entry : entries) {
+    if (entry.texture == 0) continue;
+    if (entry.pending != 0) {
+      if (entry.pendingSkip > entry.skipLevels) relief += entry.bytes - (entry.bytes >> 2);
+      continue;
+    }
+    if (entry.lastUsed < frame) candidates.push_back(&entry);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Entry* a, const Entry* b) { return a->lastUsed < b->lastUsed; });
+  for (Entry* entry : candidates) {
+    if (resident <= budgetBytes + relief) break;
+    bool stale = frame - entry->lastUsed > unloadAfter;
+    if (stale || entry->failed || entry->skipLevels + 1 >= entry->levelCount) {
+      unload(*entry);
+    } else {
+      request(*entry, entry->skipLevels + 1);
+      relief += entry->bytes - (entry->bytes >> 2);
+    }
+  }
+}
+// ------------------------------------------------------------------------
+void TextureManager::unload(Entry& entry) {
+  if (entry.texture == 0) return;
+  glState().forgetTexture(entry.texture);
+  glDeleteTextures(1, &entry.texture);
+  resident -= entry.bytes;
+  entry.texture = 0;
+  entry.bytes = 0;
+}
+// ------------------------------------------------------------------------
+std::size_t TextureManager::budget() const { return budgetBytes; }
+
+void TextureManager::setBudget(std::size_t bytes) { budgetBytes = bytes; }
+
+std::size_t TextureManager::residentBytes() const { return resident; }
+
+int TextureManager::droppedLevels(Handle handle) const {
+  return entries[handle].texture == 0 ? -1 : entries[handle].skipLevels;
+}
+
+void TextureManager::setUnloadAfterFrames(std::uint64_t frames) { unloadAfter = frames; }
+// ------------------------------------------------------------------------
+void TextureManager::release() {
+  for (Entry& entry : entries) {
+    unload(entry);
+    // a load still in flight gets uploaded later; its texture just never gets used
+    entry.pending = 0;
+  }
+  loader.recordUploads(false);
+}
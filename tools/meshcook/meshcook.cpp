@@ -0,0 +1,115 @@
+// meshcook: turns an OBJ into a MeshFile the apps can map and hand to glBufferData as it is.
+// Corners are welded into indexed vertices, ordered for the vertex cache, overdraw and fetch,
+// and packed small:
+//   positions            half floats (--float-positions keeps them 32-bit)
+//   texture coordinates  16-bit unsigned normalized, or half floats if any leave [0, 1]
+//   normals              GL_INT_2_10_10_10_REV
+// and indices are 16-bit whenever the vertices fit.
+//
+//   meshcook [--float-positions] [--no-optimize] <input.obj> <output>
+#include <mesh.h>
+#include <mesh_file.h>
+#include <mesh_optimizer.h>
+#include <obj_reader.h>
+#include <vertex_format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+  std::cout << "usage: meshcook [--float-positions] [--no-optimize] <input.obj> <output>"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  bool floatPositions = false;
+  bool optimize = true;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--float-positions") == 0) {
+      floatPositions = true;
+    } else if (std::strcmp(argv[i], "--no-optimize") == 0) {
+      optimize = false;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() != 2) {
+    printUsage();
+    return 1;
+  }
+
+  ObjMesh obj;
+  if (!readObj(paths[0], obj)) return 1;
+  if (obj.vertexCount() == 0) {
+    std::cout << "ERROR::MESHCOOK::NO_TRIANGLES: " << paths[0] << std::endl;
+    return 1;
+  }
+  MeshBuilder builder(obj.attributeSizes());
+  builder.addTriangles(obj.vertices.data(), obj.vertexCount());
+  std::vector<float> vertices = builder.vertices();
+  std::vector<std::uint32_t> indices = builder.indices();
+  int stride = builder.floatsPerVertex();
+  if (optimize) optimizeMesh(vertices, indices, stride);
+  std::size_t vertexCount = vertices.size() / stride;
+
+  float boundsMin[3], boundsMax[3];
+  for (int c = 0; c < 3; c++) boundsMin[c] = boundsMax[c] = vertices[c];
+  bool texCoordsInUnitRange = true;
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    const float* vertex = &vertices[v * stride];
+    for (int c = 0; c < 3; c++) {
+      boundsMin[c] = std::min(boundsMin[c], vertex[c]);
+      boundsMax[c] = std::max(boundsMax[c], vertex[c]);
+    }
+    if (obj.hasTexCoords) {
+      for (int c = 3; c < 5; c++) {
+        texCoordsInUnitRange = texCoordsInUnitRange && vertex[c] >= 0.0f && vertex[c] <= 1.0f;
+      }
+    }
+  }
+
+  VertexFormat format;
+  format.add(floatPositions ? VertexAttributeType::Float : VertexAttributeType::HalfFloat, 3);
+  if (obj.hasTexCoords) {
+    // repeating textures need coordinates past 1, which unorm would clamp
+    format.add(texCoordsInUnitRange ? VertexAttributeType::Unorm16
+                                    : VertexAttributeType::HalfFloat,
+               2);
+  }
+  if (obj.hasNormals) format.add(VertexAttributeType::Snorm10_10_10_2, 3);
+  std::vector<unsigned char> packed = format.pack(vertices.data(), vertexCount);
+  std::vector<MeshFileAttribute> attributes;
+  for (std::size_t i = 0; i < format.attributes().size(); i++) {
+    attributes.push_back({(std::uint32_t)i, (std::uint32_t)format.glComponents(i),
+                          (std::uint32_t)format.glType(i), (std::uint32_t)format.glNormalized(i),
+                          (std::uint32_t)format.attributes()[i].offset});
+  }
+
+  bool shortIndices = vertexCount <= 0xffff;
+  std::vector<std::uint16_t> indices16;
+  if (shortIndices) indices16.assign(indices.begin(), indices.end());
+  const void* indexData = shortIndices ? (const void*)indices16.data() : indices.data();
+  std::uint32_t indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+  if (!MeshFile::write(paths[1], attributes, (std::uint32_t)format.stride(),
+                       (std::uint32_t)vertexCount, packed.data(), indexType,
+                       (std::uint32_t)indices.size(), indexData, boundsMin, boundsMax)) {
+    std::cout << "ERROR::MESHCOOK::FILE_NOT_SUCCESSFULLY_WRITTEN: " << paths[1] << std::endl;
+    return 1;
+  }
+  std::size_t indexBytes = indices.size() * (shortIndices ? 2 : 4);
+  std::cout << paths[1] << ": " << indices.size() / 3 << " triangles, " << vertexCount
+            << " vertices of " << format.stride() << " bytes, "
+            << (shortIndices ? "16" : "32") << "-bit indices -> " << packed.size() + indexBytes
+            << " bytes (" << format.bytesSaved(vertexCount) << " saved against floats)"
+            << std::endl;
+  return 0;
+}
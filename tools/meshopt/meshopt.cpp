@@ -0,0 +1,128 @@
+// meshopt: welds an OBJ into an indexed mesh, reorders it for the post-transform vertex cache,
+// overdraw and vertex fetch, and reports what that did to ACMR and ATVR.
+//
+//   meshopt [--cache-size N] [--threshold T] [--no-overdraw] <input.obj> [<output.obj>]
+//
+// --cache-size only sets the FIFO cache the statistics simulate (16 by default); --threshold
+// is how much ACMR the overdraw pass may give up (1.05 = 5%). With an output path the result
+// is written back out as an OBJ whose faces are in the optimized order.
+#include <mesh.h>
+#include <mesh_optimizer.h>
+#include <obj_reader.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+  std::cout << "usage: meshopt [--cache-size N] [--threshold T] [--no-overdraw] <input.obj> "
+               "[<output.obj>]"
+            << std::endl;
+}
+
+void printStats(const char* label, const VertexCacheStats& stats, std::size_t vertexCount) {
+  std::cout << label << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr << " ("
+            << stats.transformedVertices << " transforms of " << vertexCount << " vertices)"
+            << std::endl;
+}
+
+// every attribute shares the vertex's index, so faces read i/i/i
+bool writeObj(const std::string& path, const ObjMesh& layout, const std::vector<float>& vertices,
+              const std::vector<std::uint32_t>& indices) {
+  std::ofstream out(path);
+  if (!out) return false;
+  int stride = layout.floatsPerVertex();
+  std::size_t vertexCount = vertices.size() / stride;
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    const float* vertex = &vertices[v * stride];
+    out << "v " << vertex[0] << " " << vertex[1] << " " << vertex[2] << "\n";
+    if (layout.hasTexCoords) out << "vt " << vertex[3] << " " << vertex[4] << "\n";
+    if (layout.hasNormals) {
+      const float* normal = vertex + (layout.hasTexCoords ? 5 : 3);
+      out << "vn " << normal[0] << " " << normal[1] << " " << normal[2] << "\n";
+    }
+  }
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    out << "f";
+    for (int k = 0; k < 3; k++) {
+      std::uint32_t index = indices[i + k] + 1;
+      out << " " << index;
+      if (layout.hasNormals) {
+        out << "/";
+        if (layout.hasTexCoords) out << index;
+        out << "/" << index;
+      } else if (layout.hasTexCoords) {
+        out << "/" << index;
+      }
+    }
+    out << "\n";
+  }
+  return (bool)out;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  unsigned int cacheSize = 16;
+  float threshold = 1.05f;
+  bool overdraw = true;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--cache-size") == 0 && i + 1 < argc) {
+      cacheSize = (unsigned int)std::strtoul(argv[++i], NULL, 10);
+    } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+      threshold = (float)std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--no-overdraw") == 0) {
+      overdraw = false;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.empty() || paths.size() > 2 || cacheSize == 0 || threshold < 1.0f) {
+    printUsage();
+    return 1;
+  }
+
+  ObjMesh obj;
+  if (!readObj(paths[0], obj)) return 1;
+  if (obj.vertexCount() == 0) {
+    std::cout << "ERROR::MESHOPT::NO_TRIANGLES: " << paths[0] << std::endl;
+    return 1;
+  }
+  MeshBuilder builder(obj.attributeSizes());
+  builder.addTriangles(obj.vertices.data(), obj.vertexCount());
+  std::vector<float> vertices = builder.vertices();
+  std::vector<std::uint32_t> indices = builder.indices();
+  std::size_t vertexCount = builder.vertexCount();
+  int stride = builder.floatsPerVertex();
+  std::cout << paths[0] << ": " << indices.size() / 3 << " triangles, " << obj.vertexCount()
+            << " corners welded to " << vertexCount << " vertices" << std::endl;
+  printStats("before", analyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize),
+             vertexCount);
+
+  optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount);
+  printStats("vertex cache",
+             analyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize),
+             vertexCount);
+  if (overdraw) {
+    optimizeOverdraw(indices.data(), indices.data(), indices.size(), vertices.data(), stride,
+                     vertexCount, threshold);
+    printStats("overdraw",
+               analyzeVertexCache(indices.data(), indices.size(), vertexCount, cacheSize),
+               vertexCount);
+  }
+  vertexCount =
+      optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertexCount, stride);
+  vertices.resize(vertexCount * stride);
+
+  if (paths.size() == 2 && !writeObj(paths[1], obj, vertices, indices)) {
+    std::cout << "ERROR::MESHOPT::FILE_NOT_SUCCESSFULLY_WRITTEN: " << paths[1] << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,135 @@
+// texcook: decodes an image, builds its mip chain and compresses every level into BCn blocks,
+// written in the TextureCacheFile container so AsyncTextureLoader can upload it as it is.
+//
+//   texcook [--format auto|bc1|bc3|bc7] [--max-size N] [--no-flip] [--no-mips] <input> <output>
+//
+// auto picks BC1 for opaque images and BC7 for images with any alpha below 255. --max-size
+// drops the mip levels larger than N on either side, so level 0 is the first that fits.
+#include <block_compression.h>
+#include <fnv1a.h>
+#include <mapped_file.h>
+#include <mip_chain.h>
+#include <stb_image.h>
+#include <texture_cache.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage() {
+  std::cout << "usage: texcook [--format auto|bc1|bc3|bc7] [--max-size N] [--no-flip] "
+               "[--no-mips] <input image> <output>"
+            << std::endl;
+}
+
+const char* blockFormatName(BlockFormat format) {
+  switch (format) {
+    case BlockFormat::BC1:
+      return "bc1";
+    case BlockFormat::BC3:
+      return "bc3";
+    default:
+      return "bc7";
+  }
+}
+
+bool hasAlpha(const unsigned char* rgba, std::size_t pixelCount) {
+  for (std::size_t i = 0; i < pixelCount; i++) {
+    if (rgba[i * 4 + 3] != 255) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string formatName = "auto";
+  bool flip = true;
+  bool mipmapped = true;
+  int maxSize = 0;
+  std::vector<std::string> paths;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+      formatName = argv[++i];
+    } else if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+      maxSize = std::atoi(argv[++i]);
+    } else if (std::strcmp(argv[i], "--no-flip") == 0) {
+      flip = false;
+    } else if (std::strcmp(argv[i], "--no-mips") == 0) {
+      mipmapped = false;
+    } else {
+      paths.push_back(argv[i]);
+    }
+  }
+  if (paths.size() != 2 || (formatName != "auto" && formatName != "bc1" &&
+                            formatName != "bc3" && formatName != "bc7")) {
+    printUsage();
+    return 1;
+  }
+
+  MappedFile source(paths[0]);
+  if (!source.isOpen()) {
+    std::cout << "ERROR::TEXCOOK::FILE_NOT_SUCCESSFULLY_READ: " << paths[0] << std::endl;
+    return 1;
+  }
+  // always decode to RGBA: the encoders work on 4 byte pixels whatever the source had
+  stbi_set_flip_vertically_on_load(flip);
+  int width = 0, height = 0, channels = 0;
+  unsigned char* pixels = stbi_load_from_memory(source.data(), (int)source.size(), &width,
+                                                &height, &channels, 4);
+  if (!pixels) {
+    std::cout << "ERROR::TEXCOOK::DECODE_FAILED: " << paths[0] << ": "
+              << (stbi_failure_reason() ? stbi_failure_reason() : "unknown error") << std::endl;
+    return 1;
+  }
+  std::vector<MipLevel> levels = mipLayout(width, height, 4, mipmapped);
+  std::vector<unsigned char> image(mipChainSize(levels));
+  std::memcpy(image.data(), pixels, levels[0].size);
+  stbi_image_free(pixels);
+  generateMipChain(image.data(), levels, 4);
+
+  BlockFormat format = BlockFormat::BC1;
+  if (formatName == "bc3") {
+    format = BlockFormat::BC3;
+  } else if (formatName == "bc7") {
+    format = BlockFormat::BC7;
+  } else if (formatName == "auto" && hasAlpha(image.data(), (std::size_t)width * height)) {
+    format = BlockFormat::BC7;
+  }
+  std::uint32_t glFormat = blockFormatGL(format);
+
+  // skip the levels over the size cap (with no mips that leaves level 0 as it is)
+  std::size_t first = 0;
+  while (maxSize > 0 && first + 1 < levels.size() &&
+         (levels[first].width > maxSize || levels[first].height > maxSize)) {
+    first++;
+  }
+  // the kept levels, now sized in blocks
+  std::vector<MipLevel> blockLevels(levels.begin() + first, levels.end());
+  std::size_t offset = 0;
+  for (MipLevel& level : blockLevels) {
+    level.offset = offset;
+    level.size = compressedLevelSize(glFormat, level.width, level.height);
+    offset += level.size;
+  }
+  std::vector<unsigned char> blocks(offset);
+  for (std::size_t i = 0; i < blockLevels.size(); i++) {
+    const MipLevel& level = levels[first + i];
+    compressImage(format, image.data() + level.offset, level.width, level.height,
+                  blocks.data() + blockLevels[i].offset);
+  }
+
+  std::uint64_t key = fnv1a64Bytes(source.data(), source.size());
+  if (!TextureCacheFile::write(paths[1], key, glFormat, 4, blockLevels, blocks.data())) {
+    std::cout << "ERROR::TEXCOOK::FILE_NOT_SUCCESSFULLY_WRITTEN: " << paths[1] << std::endl;
+    return 1;
+  }
+  std::cout << paths[1] << ": " << blockLevels[0].width << "x" << blockLevels[0].height << ", "
+            << blockLevels.size() << " levels, " << blockFormatName(format) << " -> "
+            << blocks.size() << " bytes (from " << image.size() << ")" << std::endl;
+  return 0;
+}